@@ -0,0 +1,18 @@
+/**
+ * @file hardware/clocks.h
+ * @brief Host stand-in for the clock queries used by the driver.
+ */
+
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include <pico/stdlib.h>
+
+enum clock_index
+{
+    clk_sys
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+#endif // HOST_HARDWARE_CLOCKS_H
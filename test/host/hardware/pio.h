@@ -0,0 +1,42 @@
+/**
+ * @file hardware/pio.h
+ * @brief Host stand-in for the PIO calls used by the driver.
+ *
+ * Words pushed into a state machine are logged and, once
+ * tm1637_program_init() has run on it, executed by the host model of
+ * tm1637.pio (see tm1637.pio.h), which drives the simulated GPIO lines.
+ */
+
+#ifndef HOST_HARDWARE_PIO_H
+#define HOST_HARDWARE_PIO_H
+
+#include <pico/stdlib.h>
+
+#define NUM_PIOS 2
+#define NUM_PIO_STATE_MACHINES 4
+
+typedef struct
+{
+    volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t host_pio_hw[NUM_PIOS];
+
+#define pio0 (&host_pio_hw[0])
+#define pio1 (&host_pio_hw[1])
+
+typedef struct
+{
+    int length;
+} pio_program_t;
+
+uint pio_get_index(PIO pio);
+int pio_add_program(PIO pio, const pio_program_t *program);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+
+#endif // HOST_HARDWARE_PIO_H
@@ -0,0 +1,23 @@
+/**
+ * @file hardware/sync.h
+ * @brief Host stand-in for interrupt masking and spin locks.
+ *
+ * The host runs one thread: spin locks only mask the simulated
+ * interrupts.
+ */
+
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include <pico/stdlib.h>
+
+typedef volatile uint32_t spin_lock_t;
+
+uint32_t save_and_disable_interrupts();
+void restore_interrupts(uint32_t status);
+int spin_lock_claim_unused(bool required);
+spin_lock_t *spin_lock_init(uint lock_num);
+uint32_t spin_lock_blocking(spin_lock_t *lock);
+void spin_unlock(spin_lock_t *lock, uint32_t saved_irq);
+
+#endif // HOST_HARDWARE_SYNC_H
@@ -0,0 +1,181 @@
+/**
+ * @file host_dma.cpp
+ * @brief Simulated DMA channels, DMA_IRQ_0 and interrupt masking.
+ */
+#include "host_pico.hpp"
+
+#include <hardware/dma.h>
+#include <hardware/irq.h>
+#include <hardware/sync.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * @struct HostDmaChannel
+ * @brief State of one simulated DMA channel.
+ */
+struct HostDmaChannel
+{
+    bool claimed;           ///< Returned by dma_claim_unused_channel().
+    bool busy;              ///< A triggered transfer has not completed.
+    bool irq_enabled;       ///< Completion raises DMA_IRQ_0.
+    bool irq_pending;       ///< Completion not acknowledged yet.
+    volatile void *dst;     ///< Write address, a PIO TX FIFO.
+    const uint32_t *src;    ///< Read address.
+    uint count;             ///< Words to transfer.
+    uint64_t order;         ///< Trigger order, oldest transfer first.
+};
+
+static HostDmaChannel channels[NUM_DMA_CHANNELS];
+static uint64_t triggers = 0;               ///< Transfers triggered so far.
+static irq_handler_t dma_handler = nullptr; ///< DMA_IRQ_0 handler.
+static bool dma_irq_enabled = false;        ///< DMA_IRQ_0 is enabled.
+static bool irqs_on = true;                 ///< Interrupts are not masked.
+static spin_lock_t locks[32];
+
+/**
+ * @brief Complete the oldest running DMA transfer and raise its interrupt.
+ * @return false if no transfer was running.
+ */
+bool host_dma_step()
+{
+    if (!irqs_on)
+        return false;
+    HostDmaChannel *ch = nullptr;
+    for (HostDmaChannel &c : channels)
+        if (c.busy && (!ch || c.order < ch->order))
+            ch = &c;
+    if (!ch)
+        return false;
+    for (uint p = 0; p < NUM_PIOS; ++p)
+        for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm)
+            if (ch->dst == &host_pio_hw[p].txf[sm])
+                for (uint i = 0; i < ch->count; ++i)
+                    pio_sm_put_blocking(&host_pio_hw[p], sm, ch->src[i]);
+    ch->busy = false;
+    if (ch->irq_enabled)
+    {
+        ch->irq_pending = true;
+        if (dma_handler && dma_irq_enabled)
+        {
+            irqs_on = false;
+            dma_handler();
+            irqs_on = true;
+        }
+    }
+    return true;
+}
+
+int dma_claim_unused_channel(bool)
+{
+    for (uint i = 0; i < NUM_DMA_CHANNELS; ++i)
+    {
+        if (!channels[i].claimed)
+        {
+            channels[i].claimed = true;
+            return int(i);
+        }
+    }
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint)
+{
+    return dma_channel_config{0};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *, enum dma_channel_transfer_size)
+{
+}
+
+void channel_config_set_read_increment(dma_channel_config *, bool)
+{
+}
+
+void channel_config_set_write_increment(dma_channel_config *, bool)
+{
+}
+
+void channel_config_set_dreq(dma_channel_config *, uint)
+{
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    HostDmaChannel &c = channels[channel];
+    c.dst = write_addr;
+    c.src = static_cast<const uint32_t *>(const_cast<const void *>(read_addr));
+    c.count = transfer_count;
+    c.busy = trigger;
+    c.order = triggers++;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled)
+{
+    channels[channel].irq_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel)
+{
+    return channels[channel].irq_pending;
+}
+
+void dma_channel_acknowledge_irq0(uint channel)
+{
+    channels[channel].irq_pending = false;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t)
+{
+    if (num == DMA_IRQ_0)
+        dma_handler = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    if (num == DMA_IRQ_0)
+        dma_irq_enabled = enabled;
+}
+
+uint32_t save_and_disable_interrupts()
+{
+    uint32_t status = irqs_on;
+    irqs_on = false;
+    return status;
+}
+
+void restore_interrupts(uint32_t status)
+{
+    irqs_on = status != 0;
+}
+
+int spin_lock_claim_unused(bool)
+{
+    static int next = 0;
+    return next++;
+}
+
+spin_lock_t *spin_lock_init(uint lock_num)
+{
+    return &locks[lock_num];
+}
+
+uint32_t spin_lock_blocking(spin_lock_t *lock)
+{
+    // one core taking a lock it holds spins forever on the Pico
+    if (*lock)
+    {
+        std::fprintf(stderr, "spin lock %d taken twice\n", int(lock - locks));
+        std::abort();
+    }
+    *lock = 1;
+    return save_and_disable_interrupts();
+}
+
+void spin_unlock(spin_lock_t *lock, uint32_t saved_irq)
+{
+    *lock = 0;
+    restore_interrupts(saved_irq);
+}
@@ -0,0 +1,219 @@
+/**
+ * @file host_pico.cpp
+ * @brief Simulated clock and GPIO block behind the host Pico SDK headers.
+ */
+#include "host_pico.hpp"
+
+#include <hardware/clocks.h>
+
+#include <algorithm>
+#include <poll.h>
+#include <unistd.h>
+
+static uint64_t now_us = 0;               ///< Simulated time since boot.
+static uint32_t out_ = 0;                 ///< Output latches.
+static uint32_t oe_ = 0;                  ///< Output enables.
+static uint32_t level_ = 0;               ///< Line levels seen by the device.
+static uint32_t conflict_ = 0;            ///< Lines driven high while the device pulls them low.
+static uint32_t contention_ = 0;          ///< Number of conflicts started.
+static std::vector<HostGpioDevice *> devices_; ///< Devices on the lines, none for the null backend.
+static int stdin_fd_ = -1;                ///< Source of getchar_timeout_us(), -1 for none.
+
+/**
+ * @brief Recompute the line levels and let the device follow them until nothing changes.
+ */
+static void _update()
+{
+    for (int pass = 0; pass < 4; ++pass)
+    {
+        uint32_t pulls = 0;
+        for (HostGpioDevice *device : devices_)
+            pulls |= device->pulls();
+        uint32_t conflict = oe_ & out_ & pulls;
+        contention_ += uint32_t(__builtin_popcount(conflict & ~conflict_));
+        conflict_ = conflict;
+        uint32_t level = (oe_ & out_) | (devices_.empty() ? 0 : ~oe_ & ~pulls);
+        if (level == level_)
+            return;
+        level_ = level;
+        for (HostGpioDevice *device : devices_)
+            device->lines(level);
+    }
+}
+
+/**
+ * @brief Connect a device to the GPIO lines.
+ * @param device The device.
+ */
+void host_attach(HostGpioDevice *device)
+{
+    devices_.push_back(device);
+    conflict_ = 0;
+    contention_ = 0;
+    level_ = ~level_; // make the device see the current levels
+    _update();
+}
+
+/**
+ * @brief Disconnect a device from the GPIO lines.
+ * @param device The device.
+ */
+void host_detach(HostGpioDevice *device)
+{
+    devices_.erase(std::remove(devices_.begin(), devices_.end(), device), devices_.end());
+    _update();
+}
+
+/**
+ * @brief Get the current line levels.
+ * @return Bit mask of the lines that are high.
+ */
+uint32_t host_lines()
+{
+    return level_;
+}
+
+/**
+ * @brief Get the lines driven by the host (output enabled).
+ * @return Bit mask of the driven lines.
+ */
+uint32_t host_driven()
+{
+    return oe_;
+}
+
+/**
+ * @brief Get the number of times the host started driving a line high that the device pulls low.
+ * @return The contention count since the last host_attach().
+ */
+uint32_t host_contention()
+{
+    return contention_;
+}
+
+/**
+ * @brief Set the simulated time.
+ * @param us Microseconds since boot.
+ */
+void host_set_time_us(uint64_t us)
+{
+    now_us = us;
+}
+
+uint64_t host_time_us()
+{
+    return now_us;
+}
+
+/**
+ * @brief Feed getchar_timeout_us() from a file descriptor, e.g. the read end of a pipe.
+ * @param fd The descriptor, -1 for no input.
+ */
+void host_set_stdin(int fd)
+{
+    stdin_fd_ = fd;
+}
+
+void gpio_init(uint gpio)
+{
+    out_ &= ~(1u << gpio);
+    oe_ &= ~(1u << gpio);
+    _update();
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    gpio_set_dir_masked(1u << gpio, out ? 1u << gpio : 0);
+}
+
+void gpio_pull_up(uint)
+{
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    gpio_put_masked(1u << gpio, value ? 1u << gpio : 0);
+}
+
+bool gpio_get(uint gpio)
+{
+    return (level_ & (1u << gpio)) != 0;
+}
+
+void gpio_set_mask(uint32_t mask)
+{
+    out_ |= mask;
+    _update();
+}
+
+void gpio_clr_mask(uint32_t mask)
+{
+    out_ &= ~mask;
+    _update();
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value)
+{
+    out_ = (out_ & ~mask) | (value & mask);
+    _update();
+}
+
+void gpio_set_dir_masked(uint32_t mask, uint32_t value)
+{
+    oe_ = (oe_ & ~mask) | (value & mask);
+    _update();
+}
+
+void gpio_set_dir_out_masked(uint32_t mask)
+{
+    oe_ |= mask;
+    _update();
+}
+
+void gpio_set_dir_in_masked(uint32_t mask)
+{
+    oe_ &= ~mask;
+    _update();
+}
+
+void sleep_us(uint64_t us)
+{
+    now_us += us;
+}
+
+void sleep_ms(uint32_t ms)
+{
+    now_us += uint64_t(ms) * 1000;
+}
+
+uint64_t time_us_64()
+{
+    return now_us++;
+}
+
+uint32_t time_us_32()
+{
+    return uint32_t(now_us++);
+}
+
+void tight_loop_contents()
+{
+    // the CPU waits, let the DMA make progress
+    host_dma_step();
+}
+
+int getchar_timeout_us(uint32_t timeout_us)
+{
+    if (stdin_fd_ < 0)
+        return PICO_ERROR_TIMEOUT;
+    pollfd p = {stdin_fd_, POLLIN, 0};
+    uint8_t c;
+    if ((poll(&p, 1, int(timeout_us / 1000)) <= 0) || (read(stdin_fd_, &c, 1) != 1))
+        return PICO_ERROR_TIMEOUT;
+    return c;
+}
+
+uint32_t clock_get_hz(enum clock_index)
+{
+    return 125000000;
+}
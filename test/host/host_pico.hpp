@@ -0,0 +1,135 @@
+/**
+ * @file host_pico.hpp
+ * @brief Control of the simulated Pico used by the host tests and benchmarks.
+ *
+ * The clock only moves when the driver sleeps, plus 1 us per read so that
+ * polling loops terminate. Without an attached device the GPIO block is a
+ * null backend: writes only update the latches and released lines read
+ * low, so every byte is acknowledged. Attached HostGpioDevices see the
+ * line levels after every change and may pull lines low; released lines
+ * then read high through the pull-ups.
+ *
+ * DMA transfers run when the CPU waits in tight_loop_contents() or when a
+ * test calls host_dma_step(); their completion raises DMA_IRQ_0 unless
+ * interrupts are disabled. Alarms fire when a test calls host_alarm_step().
+ */
+
+#ifndef HOST_PICO_HPP
+#define HOST_PICO_HPP
+
+#include <pico/stdlib.h>
+#include <hardware/pio.h>
+
+#include <vector>
+
+/**
+ * @class HostGpioDevice
+ * @brief A device on the simulated GPIO lines.
+ */
+class HostGpioDevice
+{
+public:
+    virtual ~HostGpioDevice() = default;
+
+    /**
+     * @brief Called whenever a line level may have changed.
+     * @param level Bit mask of the lines that are high.
+     */
+    virtual void lines(uint32_t level) = 0;
+
+    /**
+     * @brief Get the lines the device pulls low.
+     * @return Bit mask of the pulled lines.
+     */
+    virtual uint32_t pulls() const = 0;
+};
+
+/**
+ * @brief Connect a device to the GPIO lines.
+ * @param device The device.
+ */
+void host_attach(HostGpioDevice *device);
+
+/**
+ * @brief Disconnect a device from the GPIO lines.
+ * @param device The device.
+ */
+void host_detach(HostGpioDevice *device);
+
+/**
+ * @brief Get the current line levels.
+ * @return Bit mask of the lines that are high.
+ */
+uint32_t host_lines();
+
+/**
+ * @brief Get the lines driven by the host (output enabled).
+ * @return Bit mask of the driven lines.
+ */
+uint32_t host_driven();
+
+/**
+ * @brief Get the number of times the host started driving a line high that the device pulls low.
+ * @return The contention count since the last host_attach().
+ */
+uint32_t host_contention();
+
+/**
+ * @brief Set the simulated time.
+ * @param us Microseconds since boot.
+ */
+void host_set_time_us(uint64_t us);
+
+/**
+ * @brief Read the simulated time without advancing it, unlike time_us_64().
+ * @return Microseconds since boot.
+ */
+uint64_t host_time_us();
+
+/**
+ * @brief Feed getchar_timeout_us() from a file descriptor, e.g. the read end of a pipe.
+ * @param fd The descriptor, -1 for no input.
+ */
+void host_set_stdin(int fd);
+
+/**
+ * @brief Complete the oldest running DMA transfer and raise its interrupt.
+ * @return false if no transfer was running.
+ */
+bool host_dma_step();
+
+/**
+ * @brief Run the callbacks of every alarm due at the current time, earliest first.
+ * @return false if no alarm was due.
+ */
+bool host_alarm_step();
+
+/**
+ * @struct HostPioStep
+ * @brief Line levels while one instruction of the tm1637 program executes.
+ */
+struct HostPioStep
+{
+    uint32_t cycle; ///< State machine cycle the instruction started in.
+    bool clk;       ///< CLK level.
+    bool dio;       ///< DIO level.
+    bool dio_out;   ///< DIO is driven by the state machine.
+};
+
+/**
+ * @brief Get the words pushed into a state machine's TX FIFO.
+ * @param pio PIO instance.
+ * @param sm State machine index.
+ * @return The words, oldest first.
+ */
+std::vector<uint32_t> &host_pio_words(PIO pio, uint sm);
+
+/**
+ * @brief Get the instruction trace of a state machine running the tm1637 program model.
+ * @param pio PIO instance.
+ * @param sm State machine index.
+ * @return One entry per executed instruction.
+ */
+std::vector<HostPioStep> &host_pio_trace(PIO pio, uint sm);
+
+#endif // HOST_PICO_HPP
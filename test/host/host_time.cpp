@@ -0,0 +1,82 @@
+/**
+ * @file host_time.cpp
+ * @brief Simulated hardware alarms on the host clock.
+ */
+#include "host_pico.hpp"
+
+#include <pico/time.h>
+
+#include <map>
+
+/**
+ * @struct HostAlarm
+ * @brief One armed alarm.
+ */
+struct HostAlarm
+{
+    uint64_t at;               ///< Time the alarm is due (us since boot).
+    alarm_callback_t callback; ///< Called when due.
+    void *user;                ///< Passed to callback.
+};
+
+static std::map<alarm_id_t, HostAlarm> alarms;
+static alarm_id_t next_id = 1;
+
+/**
+ * @brief Run an alarm callback and reschedule it like the SDK does.
+ * @param id The alarm.
+ * @param alarm Its state; at is updated when it is rescheduled.
+ * @return true if the alarm stays armed.
+ */
+static bool fire(alarm_id_t id, HostAlarm &alarm)
+{
+    int64_t again = alarm.callback(id, alarm.user);
+    if (!again)
+        return false;
+    // negative: relative to when it was due, positive: relative to now
+    alarm.at = (again < 0) ? alarm.at + uint64_t(-again) : host_time_us() + uint64_t(again);
+    return true;
+}
+
+absolute_time_t from_us_since_boot(uint64_t us)
+{
+    return us;
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+    alarm_id_t id = next_id++;
+    HostAlarm alarm{time, callback, user_data};
+    if (time <= host_time_us())
+    {
+        if (!fire_if_past || !fire(id, alarm))
+            return 0;
+    }
+    alarms[id] = alarm;
+    return id;
+}
+
+bool cancel_alarm(alarm_id_t alarm_id)
+{
+    return alarms.erase(alarm_id) > 0;
+}
+
+bool host_alarm_step()
+{
+    bool fired = false;
+    for (;;)
+    {
+        auto due = alarms.end();
+        for (auto it = alarms.begin(); it != alarms.end(); ++it)
+            if ((it->second.at <= host_time_us()) && ((due == alarms.end()) || (it->second.at < due->second.at)))
+                due = it;
+        if (due == alarms.end())
+            return fired;
+        fired = true;
+        alarm_id_t id = due->first;
+        HostAlarm alarm = due->second;
+        alarms.erase(due);
+        if (fire(id, alarm))
+            alarms[id] = alarm;
+    }
+}
@@ -0,0 +1,11 @@
+/**
+ * @file pico.h
+ * @brief Host stand-in for the Pico SDK base header (section placement macros).
+ */
+
+#ifndef HOST_PICO_H
+#define HOST_PICO_H
+
+#include <pico/stdlib.h>
+
+#endif // HOST_PICO_H
@@ -0,0 +1,46 @@
+/**
+ * @file pico/stdlib.h
+ * @brief Host stand-in for the parts of the Pico SDK used by the driver.
+ *
+ * Declares the SDK calls the driver sources make; host_pico.cpp implements
+ * them on a simulated clock and GPIO block, see host_pico.hpp.
+ */
+
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+#define __not_in_flash(group) __attribute__((section(".time_critical." group)))
+#define __not_in_flash_func(func_name) __not_in_flash(#func_name) func_name
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_pull_up(uint gpio);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_mask(uint32_t mask);
+void gpio_clr_mask(uint32_t mask);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+void gpio_set_dir_masked(uint32_t mask, uint32_t value);
+void gpio_set_dir_out_masked(uint32_t mask);
+void gpio_set_dir_in_masked(uint32_t mask);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+uint64_t time_us_64();
+uint32_t time_us_32();
+
+void tight_loop_contents();
+
+#define PICO_ERROR_TIMEOUT (-1)
+
+int getchar_timeout_us(uint32_t timeout_us);
+
+#endif // HOST_PICO_STDLIB_H
@@ -0,0 +1,22 @@
+/**
+ * @file pico/time.h
+ * @brief Host stand-in for the Pico SDK alarms.
+ *
+ * Alarms fire when a test calls host_alarm_step() after moving the clock,
+ * see host_pico.hpp; host_time.cpp implements them.
+ */
+
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+#include <pico/stdlib.h>
+
+typedef int32_t alarm_id_t;
+typedef uint64_t absolute_time_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+absolute_time_t from_us_since_boot(uint64_t us);
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t alarm_id);
+
+#endif // HOST_PICO_TIME_H
@@ -0,0 +1,39 @@
+/**
+ * @file tm1637.pio.h
+ * @brief Host model of tm1637.pio, standing in for the header pioasm generates.
+ *
+ * tm1637_program_run() executes the program for one TX FIFO word,
+ * instruction by instruction, on the simulated GPIO lines. Keep it in step
+ * with tm1637.pio.
+ */
+
+#ifndef HOST_TM1637_PIO_H
+#define HOST_TM1637_PIO_H
+
+#include <hardware/pio.h>
+
+/**
+ * @brief Program length in instructions; tm1637_pio_test counts them in tm1637.pio.
+ */
+static const pio_program_t tm1637_program = {19};
+
+/**
+ * @brief Start the program model on a state machine.
+ * @param pio PIO instance.
+ * @param sm State machine index.
+ * @param offset Offset the program was loaded at.
+ * @param clk Pin number for the clock (CLK) line.
+ * @param dio Pin number for the data (DIO) line.
+ * @param half_period_us Bus half period in microseconds.
+ */
+void tm1637_program_init(PIO pio, uint sm, uint offset, uint clk, uint dio, uint half_period_us);
+
+/**
+ * @brief Execute the program for one word pulled from the TX FIFO.
+ * @param pio PIO instance.
+ * @param sm State machine index.
+ * @param word The word.
+ */
+void tm1637_program_run(PIO pio, uint sm, uint32_t word);
+
+#endif // HOST_TM1637_PIO_H
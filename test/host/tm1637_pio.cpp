@@ -0,0 +1,168 @@
+/**
+ * @file tm1637_pio.cpp
+ * @brief Host PIO block running the model of tm1637.pio.
+ */
+#include "host_pico.hpp"
+#include "tm1637.pio.h"
+
+pio_hw_t host_pio_hw[NUM_PIOS];
+
+/**
+ * @struct HostSm
+ * @brief State of one simulated state machine.
+ */
+struct HostSm
+{
+    bool running = false;           ///< tm1637_program_init() has run.
+    uint32_t clk = 0;               ///< CLK pin mask (side-set).
+    uint32_t dio = 0;               ///< DIO pin mask (out/set pins).
+    uint32_t cycle = 0;             ///< Cycles executed.
+    std::vector<uint32_t> words;    ///< Words pushed into the TX FIFO.
+    std::vector<HostPioStep> trace; ///< Executed instructions.
+};
+
+static HostSm sms[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+
+/**
+ * @brief Get the state machine behind a PIO and index.
+ */
+static HostSm &_sm(PIO pio, uint sm)
+{
+    return sms[pio_get_index(pio)][sm];
+}
+
+uint pio_get_index(PIO pio)
+{
+    return uint(pio - host_pio_hw);
+}
+
+int pio_add_program(PIO, const pio_program_t *)
+{
+    return 0;
+}
+
+void pio_sm_claim(PIO, uint)
+{
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+    HostSm &s = _sm(pio, sm);
+    s.words.push_back(data);
+    if (s.running)
+        tm1637_program_run(pio, sm, data);
+}
+
+void pio_sm_set_clkdiv(PIO, uint, float)
+{
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool)
+{
+    return pio_get_index(pio) * 8 + sm;
+}
+
+/**
+ * @brief Get the words pushed into a state machine's TX FIFO.
+ * @param pio PIO instance.
+ * @param sm State machine index.
+ * @return The words, oldest first.
+ */
+std::vector<uint32_t> &host_pio_words(PIO pio, uint sm)
+{
+    return _sm(pio, sm).words;
+}
+
+/**
+ * @brief Get the instruction trace of a state machine running the tm1637 program model.
+ * @param pio PIO instance.
+ * @param sm State machine index.
+ * @return One entry per executed instruction.
+ */
+std::vector<HostPioStep> &host_pio_trace(PIO pio, uint sm)
+{
+    return _sm(pio, sm).trace;
+}
+
+/**
+ * @brief Start the program model on a state machine.
+ * @param pio PIO instance.
+ * @param sm State machine index.
+ * @param offset Offset the program was loaded at.
+ * @param clk Pin number for the clock (CLK) line.
+ * @param dio Pin number for the data (DIO) line.
+ * @param half_period_us Bus half period in microseconds.
+ */
+void tm1637_program_init(PIO pio, uint sm, uint, uint clk, uint dio, uint)
+{
+    HostSm &s = _sm(pio, sm);
+    s.running = true;
+    s.clk = 1u << clk;
+    s.dio = 1u << dio;
+    // both pins outputs and high, like pio_sm_set_pins/pindirs_with_mask()
+    gpio_put_masked(s.clk | s.dio, s.clk | s.dio);
+    gpio_set_dir_masked(s.clk | s.dio, s.clk | s.dio);
+}
+
+/**
+ * @brief Execute the program for one word pulled from the TX FIFO.
+ * @param pio PIO instance.
+ * @param sm State machine index.
+ * @param word The word.
+ */
+void tm1637_program_run(PIO pio, uint sm, uint32_t word)
+{
+    HostSm &s = _sm(pio, sm);
+    uint32_t osr = word;
+    // one instruction: side-set and pin action take effect together, then
+    // the instruction and its delay cycles elapse
+    auto exec = [&](int side, int pins, int pindirs, int delay)
+    {
+        if (side >= 0)
+            gpio_put_masked(s.clk, side ? s.clk : 0);
+        if (pins >= 0)
+            gpio_put_masked(s.dio, pins ? s.dio : 0);
+        if (pindirs >= 0)
+            gpio_set_dir_masked(s.dio, pindirs ? s.dio : 0);
+        uint32_t level = host_lines();
+        s.trace.push_back({s.cycle, (level & s.clk) != 0, (level & s.dio) != 0, (host_driven() & s.dio) != 0});
+        s.cycle += 1 + uint32_t(delay);
+    };
+    auto out = [&]()
+    {
+        uint32_t bit = osr & 1u;
+        osr >>= 1;
+        return int(bit);
+    };
+
+    exec(-1, -1, -1, 0);         // pull block
+    int x = out();               // out x, 1
+    exec(-1, -1, -1, 0);
+    exec(-1, -1, -1, 0);         // jmp !x data
+    if (x)
+    {
+        exec(1, 1, -1, 7);       // set pins, 1 side 1 [7]
+        exec(-1, 0, -1, 7);      // set pins, 0 [7]
+        exec(0, -1, -1, 7);      // nop side 0 [7]
+    }
+    exec(-1, -1, -1, 0);         // set y, 7
+    for (int y = 7; y >= 0; --y)
+    {
+        exec(-1, out(), -1, 7);  // out pins, 1 [7]
+        exec(1, -1, -1, 7);      // nop side 1 [7]
+        exec(0, -1, -1, 7);      // jmp y-- bit side 0 [7]
+    }
+    exec(-1, -1, 0, 7);          // set pindirs, 0 [7]
+    exec(1, -1, -1, 7);          // nop side 1 [7]
+    exec(0, -1, -1, 7);          // nop side 0 [7]
+    exec(-1, -1, 1, 0);          // set pindirs, 1
+    x = out();                   // out x, 1
+    exec(-1, -1, -1, 0);
+    exec(-1, -1, -1, 0);         // jmp !x next
+    if (x)
+    {
+        exec(-1, 0, -1, 7);      // set pins, 0 [7]
+        exec(1, -1, -1, 7);      // nop side 1 [7]
+        exec(-1, 1, -1, 7);      // set pins, 1 [7]
+    }
+}
@@ -0,0 +1,177 @@
+/**
+ * @file tm1637_bench.cpp
+ * @brief Host micro-benchmark of the encode and frame-build paths.
+ *
+ * The driver runs on the null GPIO backend of host_pico.cpp, so the times
+ * are the CPU cost of the driver alone. Output is one line per case:
+ *
+ *     <case> <ns/op> <allocs/op> <bus bytes/op>
+ *
+ * Columns are separated by tabs and the case names are fixed, so the
+ * output of two builds can be diffed directly.
+ *
+ * The byte_gpio_put and byte_mask cases bypass the driver: they clock one
+ * byte plus the ACK slot through SIO registers written the way the SDK's
+ * inline gpio calls write them, once per pin with gpio_put() and once with
+ * precomputed masks, without the bus delays. The bytes are scrambled so
+ * the data branches of the gpio_put() path cannot be predicted.
+ */
+#include "tm1637.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @brief Heap allocations made since start.
+ */
+static size_t allocations = 0;
+
+void *operator new(size_t size)
+{
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * @brief Keeps results alive so the compiler cannot drop the measured calls.
+ */
+static volatile uint32_t sink;
+
+/**
+ * @brief SIO output registers written by the byte_* cases.
+ */
+static struct
+{
+    volatile uint32_t out;  ///< Output latches.
+    volatile uint32_t set;  ///< Set register.
+    volatile uint32_t clr;  ///< Clear register.
+    volatile uint32_t togl; ///< Toggle register.
+} sio;
+
+/**
+ * @brief Pins and masks of the byte_* cases. Volatile, because the driver
+ * reloads its members after every bus delay, which is an opaque call.
+ */
+static volatile uint8_t clk_pin = 2, dio_pin = 3;
+static volatile uint32_t clk_mask = 1u << 2, dio_mask = 1u << 3;
+
+/**
+ * @brief gpio_put() as the SDK inlines it: a shift and a branch per edge.
+ * @param gpio Pin number.
+ * @param value Level to drive.
+ */
+static inline void sio_put(uint gpio, bool value)
+{
+    uint32_t mask = 1ul << gpio;
+    if (value)
+        sio.set = mask;
+    else
+        sio.clr = mask;
+}
+
+/**
+ * @brief Clock one byte and the ACK slot with gpio_put(), as before the pin masks.
+ * @param b The byte to be written.
+ */
+__attribute__((noinline)) static void byte_gpio_put(uint8_t b)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        sio_put(dio_pin, (b >> i) & 1);
+        sio_put(clk_pin, 1);
+        sio_put(clk_pin, 0);
+    }
+    sio_put(clk_pin, 0);
+    sio_put(clk_pin, 1);
+    sio_put(clk_pin, 0);
+}
+
+/**
+ * @brief Clock one byte and the ACK slot with precomputed masks, as _write_byte() does.
+ * @param b The byte to be written.
+ */
+__attribute__((noinline)) static void byte_mask(uint8_t b)
+{
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i)
+    {
+        sio.togl = (sio.out ^ (0u - ((b >> i) & 1u))) & dio_mask; // gpio_put_masked()
+        sio.set = clk_mask;
+        sio.clr = clk_mask;
+    }
+    sio.clr = clk_mask;
+    sio.set = clk_mask;
+    sio.clr = clk_mask;
+}
+
+/**
+ * @brief Run one case and print its line.
+ * @param name Case name.
+ * @param display Display whose bus bytes are counted.
+ * @param iterations Number of calls.
+ * @param op Callable running one call.
+ */
+template <class Op>
+static void run(const char *name, TM1637 &display, uint32_t iterations, Op op)
+{
+    for (uint32_t i = 0; i < iterations / 16; ++i)
+        op(i); // warm up
+    display.reset_stats();
+    size_t allocs = allocations;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+        op(i);
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    std::printf("%s\t%.1f\t%.2f\t%.2f\n", name, ns / iterations,
+                double(allocations - allocs) / iterations,
+                double(display.stats().bytes) / iterations);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t n = (argc > 1) ? uint32_t(std::strtoul(argv[1], nullptr, 10)) : 100000;
+    TM1637 display(2, 3);
+    Segments six = display.encode_string("123456");
+
+    std::printf("# case\tns/op\tallocs/op\tbytes/op\n");
+    run("encode_char", display, n, [&](uint32_t i)
+        { sink = display.encode_char(char('0' + i % 75)); });
+    run("encode_string", display, n, [&](uint32_t)
+        { sink = display.encode_string("12.3456")[0]; });
+    run("format_value", display, n, [&](uint32_t i)
+        { sink = uint32_t(TM1637::format_value(3.14159 * i).size()); });
+    run("tm16xx_encode_text", display, n, [&](uint32_t)
+        {
+            uint8_t segments[TM1637Chip::GRIDS] = {};
+            tm16xx_encode_text<TM1637Chip>("12.3456", 7, segments);
+            sink = segments[0];
+        });
+    run("number", display, n, [&](uint32_t i)
+        { display.number(i); });
+    run("hex", display, n, [&](uint32_t i)
+        { display.hex(uint16_t(i)); });
+    run("show", display, n, [&](uint32_t)
+        { display.show("12.3456"); });
+    run("write", display, n, [&](uint32_t)
+        { display.write(six); });
+    run("byte_gpio_put", display, n, [&](uint32_t i)
+        { byte_gpio_put(uint8_t((i * 0x9E3779B1u) >> 24)); });
+    run("byte_mask", display, n, [&](uint32_t i)
+        { byte_mask(uint8_t((i * 0x9E3779B1u) >> 24)); });
+    return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file tm1637_calibrate_test.cpp
+ * @brief Host test of calibrate() against a virtual chip with a minimum half period.
+ */
+#include "tm1637.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+/**
+ * @brief A delay that passes is walked down to the fastest one the chip follows.
+ */
+static void test_walk_down()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    chip.min_half_us = 4;
+    CHECK_EQ(display.calibrate(50, 4), 6);
+    CHECK_EQ(display.bus_delay(), 6);
+}
+
+/**
+ * @brief A delay that already fails is raised until the chip follows, not kept.
+ */
+static void test_search_up()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    display.write(display.encode_string("123456"));
+    chip.min_half_us = 37;
+    CHECK_EQ(display.calibrate(0, 4), 37);
+    CHECK_EQ(display.bus_delay(), 37);
+
+    // the display content survives the failing trials
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], display.encode_string("123456")[TM1637Chip::digit_at(addr)]);
+}
+
+/**
+ * @brief No delay passes: failure is reported and the previous delay kept.
+ */
+static void test_nothing_passes()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    display.set_retry_policy(0, 0);
+    uint8_t before = display.bus_delay();
+    chip.min_half_us = 1000;
+    CHECK_EQ(display.calibrate(50, 2), 0);
+    CHECK_EQ(display.bus_delay(), before);
+}
+
+int main()
+{
+    test_walk_down();
+    test_search_up();
+    test_nothing_passes();
+    return check_result();
+}
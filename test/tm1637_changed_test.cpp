@@ -0,0 +1,56 @@
+/**
+ * @file tm1637_changed_test.cpp
+ * @brief Host test of write_changed() against the display RAM of a virtual chip.
+ */
+#include "tm1637.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+/**
+ * @brief The constructor clears the chip RAM, so a blank digit is never skipped.
+ */
+static void test_power_up()
+{
+    TM1637Model chip(2, 3);
+    for (uint8_t &b : chip.ram)
+        b = 0x7F; // power-up garbage
+    TM1637 display(2, 3);
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], 0);
+
+    // only the digit that differs from the blank shadow is sent, the rest is already blank
+    uint8_t segments[6] = {0, 0, 0, 0, 0, display.encode_char('7')};
+    CHECK_EQ(display.write_changed(segments), 1u);
+    CHECK_EQ(chip.ram[3], display.encode_char('7'));
+    for (size_t addr : {0, 1, 2, 4, 5})
+        CHECK_EQ(chip.ram[addr], 0);
+}
+
+/**
+ * @brief Only the span of changed addresses goes out; an unchanged frame costs no bus time.
+ */
+static void test_span()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    Segments frame = display.encode_string("123456");
+    CHECK_EQ(display.write_changed(frame.data()), 6u);
+
+    size_t before = chip.transactions.size();
+    CHECK_EQ(display.write_changed(frame.data()), 0u);
+    CHECK_EQ(chip.transactions.size(), before);
+
+    // digits 0 and 2 are RAM addresses 2 and 0: the span covers 0..2
+    frame[0] = display.encode_char('9');
+    frame[2] = display.encode_char('9');
+    CHECK_EQ(display.write_changed(frame.data()), 3u);
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], frame[TM1637Chip::digit_at(addr)]);
+}
+
+int main()
+{
+    test_power_up();
+    test_span();
+    return check_result();
+}
@@ -0,0 +1,58 @@
+/**
+ * @file tm1637_check.hpp
+ * @brief Minimal check macros for the host tests.
+ *
+ * A failed check prints its location and expression and the test keeps
+ * going; main() returns check_result() so ctest sees the failures.
+ */
+
+#ifndef TM1637_CHECK_HPP
+#define TM1637_CHECK_HPP
+
+#include <cstdio>
+
+/**
+ * @brief Number of failed checks.
+ */
+inline int check_failures = 0;
+
+/**
+ * @brief Check a condition.
+ */
+#define CHECK(cond)                                                                   \
+    do                                                                                \
+    {                                                                                 \
+        if (!(cond))                                                                  \
+        {                                                                             \
+            ++check_failures;                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        }                                                                             \
+    } while (0)
+
+/**
+ * @brief Check that two integers are equal, printing both when they are not.
+ */
+#define CHECK_EQ(a, b)                                                                      \
+    do                                                                                      \
+    {                                                                                       \
+        long long a_ = (long long)(a), b_ = (long long)(b);                                 \
+        if (a_ != b_)                                                                       \
+        {                                                                                   \
+            ++check_failures;                                                               \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, \
+                         __LINE__, #a, #b, a_, b_);                                         \
+        }                                                                                   \
+    } while (0)
+
+/**
+ * @brief Report the outcome of a test.
+ * @return The exit code of the test, 0 if every check passed.
+ */
+inline int check_result()
+{
+    if (check_failures)
+        std::fprintf(stderr, "%d check(s) failed\n", check_failures);
+    return check_failures ? 1 : 0;
+}
+
+#endif // TM1637_CHECK_HPP
@@ -0,0 +1,167 @@
+/**
+ * @file tm1637_coro_test.cpp
+ * @brief Host test interleaving display coroutines on DMA driven displays.
+ *
+ * The simulated DMA only completes a transfer while the CPU waits in
+ * tight_loop_contents(), i.e. when the executor has nothing ready to run.
+ * A coroutine that polled for a free frame buffer would keep the ready
+ * queue busy and never let that happen, so these tests only finish if
+ * waiting coroutines are parked until the DMA frees a buffer.
+ */
+#include "tm1637_coro.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+#include <string>
+
+/**
+ * @brief Order in which the coroutines got their frames out.
+ */
+static std::vector<std::string> events;
+
+/**
+ * @brief Show "<name><i>" for i = 0 .. frames - 1.
+ */
+static TM1637Task counter(TM1637Executor &ex, TM1637 &display, std::string name, int frames)
+{
+    for (int i = 0; i < frames; ++i)
+    {
+        std::string text = name + std::to_string(i);
+        co_await show_async(ex, display, text);
+        events.push_back(text);
+    }
+}
+
+/**
+ * @brief Step the brightness down from 7 to 0.
+ */
+static TM1637Task dimmer(TM1637Executor &ex, TM1637 &display)
+{
+    for (int b = 7; b >= 0; --b)
+    {
+        co_await brightness_async(ex, display, uint8_t(b));
+        events.push_back("b" + std::to_string(b));
+    }
+}
+
+/**
+ * @brief Get the display RAM contents of every address transaction the chip received.
+ */
+static std::vector<std::vector<uint8_t>> frames(const TM1637Model &chip)
+{
+    std::vector<std::vector<uint8_t>> out;
+    for (const std::vector<uint8_t> &t : chip.transactions)
+        if (!t.empty() && (t[0] == TM1637_CMD2))
+            out.emplace_back(t.begin() + 1, t.end());
+    return out;
+}
+
+/**
+ * @brief Get the display RAM contents show() produces for a text.
+ */
+static std::vector<uint8_t> ram_of(TM1637 &display, const std::string &text)
+{
+    Segments segments = display.encode_string(text);
+    std::vector<uint8_t> ram(6);
+    for (size_t addr = 0; addr < 6; ++addr)
+        ram[addr] = segments[TM1637Chip::digit_at(addr)];
+    return ram;
+}
+
+/**
+ * @brief Position of an event in the log, or -1.
+ */
+static int at(const std::string &event)
+{
+    for (size_t i = 0; i < events.size(); ++i)
+        if (events[i] == event)
+            return int(i);
+    return -1;
+}
+
+/**
+ * @brief Two displays updated by their own coroutines progress side by side.
+ */
+static void test_two_displays()
+{
+    TM1637Model chip_a(2, 3);
+    TM1637Model chip_b(4, 5);
+    TM1637 a(2, 3, pio0, 0);
+    TM1637 b(4, 5, pio0, 1);
+    chip_a.transactions.clear(); // the constructors clear the RAM
+    chip_b.transactions.clear();
+    events.clear();
+
+    TM1637Executor ex;
+    CHECK(ex.spawn(counter(ex, a, "a", 5)));
+    CHECK(ex.spawn(counter(ex, b, "b", 5)));
+    ex.run();
+
+    CHECK_EQ(events.size(), 10u);
+    CHECK(at("b0") < at("a4")); // interleaved, not one after the other
+    CHECK(at("a0") < at("b4"));
+    std::vector<std::vector<uint8_t>> sent_a = frames(chip_a), sent_b = frames(chip_b);
+    CHECK_EQ(sent_a.size(), 5u);
+    CHECK_EQ(sent_b.size(), 5u);
+    for (int i = 0; i < 5 && i < int(sent_a.size()) && i < int(sent_b.size()); ++i)
+    {
+        CHECK(sent_a[i] == ram_of(a, "a" + std::to_string(i)));
+        CHECK(sent_b[i] == ram_of(b, "b" + std::to_string(i)));
+    }
+}
+
+/**
+ * @brief Three writers and a dimmer share one display's two frame buffers.
+ */
+static void test_shared_display()
+{
+    TM1637Model chip(6, 7);
+    TM1637 display(6, 7, pio0, 2);
+    chip.transactions.clear();
+    events.clear();
+
+    TM1637Executor ex;
+    CHECK(ex.spawn(counter(ex, display, "c", 4)));
+    CHECK(ex.spawn(counter(ex, display, "d", 4)));
+    CHECK(ex.spawn(counter(ex, display, "e", 4)));
+    CHECK(ex.spawn(dimmer(ex, display)));
+    ex.run();
+
+    CHECK_EQ(events.size(), 20u);
+    CHECK(!display.busy());
+    // every frame arrived whole, each writer's frames in order
+    std::vector<std::vector<uint8_t>> sent = frames(chip);
+    CHECK_EQ(sent.size(), 12u);
+    for (const char *name : {"c", "d", "e"})
+    {
+        size_t next = 0;
+        for (const std::vector<uint8_t> &f : sent)
+            if ((next < 4) && (f == ram_of(display, name + std::to_string(next))))
+                ++next;
+        CHECK_EQ(next, 4u);
+    }
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 0);
+}
+
+/**
+ * @brief Frames that do not map onto whole wiring groups are refused.
+ */
+static void test_frame_sizes()
+{
+    TM1637 display(8, 9, pio0, 3);
+    for (size_t n = 0; n <= 7; ++n)
+    {
+        bool sent = display.submit(Segments(n, 0x3F));
+        CHECK_EQ(sent, (n == 3) || (n == 6));
+        while (host_dma_step())
+            ;
+    }
+}
+
+int main()
+{
+    test_two_displays();
+    test_shared_display();
+    test_frame_sizes();
+    return check_result();
+}
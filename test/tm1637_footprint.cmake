@@ -0,0 +1,19 @@
+# Fails if a linked program refers to the C++ stream or locale machinery.
+#
+#   cmake -DNM=<nm> -DPROGRAM=<executable> -P tm1637_footprint.cmake
+#
+# Run by ctest on tm1637_footprint, which links every driver module.
+execute_process(COMMAND ${NM} -C ${PROGRAM}
+                OUTPUT_VARIABLE symbols
+                RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "${NM} failed on ${PROGRAM}")
+endif()
+
+string(REGEX MATCHALL "[^\n]*(std::ios_base|std::locale|std::basic_[io]stream|std::basic_ostream|std::basic_istream|std::basic_stringbuf|std::__cxx11::basic_stringbuf|std::basic_streambuf|std::cout|std::cerr)[^\n]*"
+       found "${symbols}")
+if (found)
+    string(REPLACE ";" "\n" found "${found}")
+    message(FATAL_ERROR "${PROGRAM} depends on the stream library:\n${found}")
+endif()
+message(STATUS "${PROGRAM}: no stream or locale symbols")
@@ -0,0 +1,52 @@
+/**
+ * @file tm1637_footprint.cpp
+ * @brief Minimal program linking every driver module, checked by tm1637_footprint.cmake.
+ *
+ * The check fails if the linked program refers to the stream or locale
+ * machinery of the C++ library, which would add its static initializers
+ * and several kilobytes to every image using the driver.
+ */
+#include "tm1637.hpp"
+#include "tm1637_framebuffer.hpp"
+#include "tm1637_link_rx.hpp"
+#include "tm1637_manager.hpp"
+#include "tm1637_meter.hpp"
+#include "tm1637_scene.hpp"
+#include "tm1637_timer.hpp"
+
+static constexpr TM1637Page PAGES[] = {tm1637_page("SEt  1", 5, 1000), tm1637_page("run.", 7, 500)};
+
+int main()
+{
+    TM1637 display(2, 3);
+    display.show("12.3456");
+    display.value(-3.14159);
+    display.number(1234567);
+    display.hex(0xbeef);
+
+    TM1637Keypad keypad;
+    display.attach_keypad(&keypad);
+    display.poll_keys();
+
+    TM1637Manager manager;
+    manager.add(display);
+    TM1637LinkReceiver link(manager);
+    link.poll();
+    manager.service();
+
+    TM1637ScenePlayer player(display);
+    player.play(PAGES, 2);
+    player.update();
+
+    TM1637Framebuffer fb(display);
+    fb.toggle(0, TM1637_SEG_DP);
+    fb.flush();
+
+    TM1637LevelMeter meter(display);
+    meter.update(100, 4095);
+
+    TM1637Timer timer(display);
+    timer.start_countdown(60000);
+    timer.update();
+    return 0;
+}
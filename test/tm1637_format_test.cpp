@@ -0,0 +1,95 @@
+/**
+ * @file tm1637_format_test.cpp
+ * @brief Host test of format_value() across field widths, including the overflow and NaN/Inf texts.
+ */
+#include "tm1637.hpp"
+#include "tm1637_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+/**
+ * @brief Check a formatted text, printing both when they differ.
+ */
+#define CHECK_TEXT(got, want)                                                                          \
+    do                                                                                                 \
+    {                                                                                                  \
+        std::string got_ = (got);                                                                      \
+        if (got_ != (want))                                                                            \
+        {                                                                                              \
+            ++check_failures;                                                                          \
+            std::fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #got,   \
+                         got_.c_str(), want);                                                          \
+        }                                                                                              \
+    } while (0)
+
+/**
+ * @brief The result never takes more digits than the field has.
+ */
+static void test_width()
+{
+    const double values[] = {0, 5, -5, 10, -99, 0.5, -0.5, 1234, 123456, -123456, 1e20, -1e20, 1e-20,
+                             NAN, INFINITY, -INFINITY};
+    for (uint8_t digits = 1; digits <= 6; ++digits)
+    {
+        for (double v : values)
+        {
+            std::string s = TM1637::format_value(v, digits);
+            size_t shown = s.size() - size_t(std::count(s.begin(), s.end(), '.'));
+            CHECK_EQ(shown, digits);
+        }
+    }
+}
+
+/**
+ * @brief Narrow fields: "OFL", "nAn" and "Inf" only where they fit, dashes otherwise.
+ */
+static void test_narrow()
+{
+    CHECK_TEXT(TM1637::format_value(7, 1), "7");
+    CHECK_TEXT(TM1637::format_value(10, 1), "-");
+    CHECK_TEXT(TM1637::format_value(123456, 1), "-");
+    CHECK_TEXT(TM1637::format_value(-5, 1), "-");
+    CHECK_TEXT(TM1637::format_value(NAN, 1), "-");
+
+    CHECK_TEXT(TM1637::format_value(-5, 2), "-5");
+    CHECK_TEXT(TM1637::format_value(1234, 2), "1k");
+    CHECK_TEXT(TM1637::format_value(123456, 2), "--");
+    CHECK_TEXT(TM1637::format_value(-99, 2), "--");
+    CHECK_TEXT(TM1637::format_value(INFINITY, 2), "--");
+
+    CHECK_TEXT(TM1637::format_value(123456, 3), "1E5");
+    CHECK_TEXT(TM1637::format_value(1e20, 3), "OFL");
+    CHECK_TEXT(TM1637::format_value(-123456, 3), "---");
+    CHECK_TEXT(TM1637::format_value(-1e20, 3), "---");
+    CHECK_TEXT(TM1637::format_value(NAN, 3), "nAn");
+    CHECK_TEXT(TM1637::format_value(-INFINITY, 3), "---");
+    CHECK_TEXT(TM1637::format_value(3.14159, 3), "3.14");
+
+    CHECK_TEXT(TM1637::format_value(-1e20, 4), "-OFL");
+    CHECK_TEXT(TM1637::format_value(-INFINITY, 4), "-Inf");
+}
+
+/**
+ * @brief Full-width fields keep their usual renderings.
+ */
+static void test_full()
+{
+    CHECK_TEXT(TM1637::format_value(3.14159), "3.14159");
+    CHECK_TEXT(TM1637::format_value(-0.0012), "-0.0012");
+    CHECK_TEXT(TM1637::format_value(123456), "123456");
+    CHECK_TEXT(TM1637::format_value(-123456), "-123.5k");
+    CHECK_TEXT(TM1637::format_value(1e20), "  1E20");
+    CHECK_TEXT(TM1637::format_value(1e-20), " 1E-20");
+    CHECK_TEXT(TM1637::format_value(NAN), "   nAn");
+    CHECK_TEXT(TM1637::format_value(-INFINITY), "  -Inf");
+}
+
+int main()
+{
+    test_width();
+    test_narrow();
+    test_full();
+    return check_result();
+}
@@ -0,0 +1,196 @@
+/**
+ * @file tm1637_framebuffer_test.cpp
+ * @brief Host test of the segment framebuffer: drawing calls, clipping and single-transaction flushes.
+ */
+#include "tm1637_framebuffer.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+/**
+ * @brief Stand-in display for a chip without a driver, recording what a flush hands over.
+ */
+struct RecordingDisplay
+{
+    uint8_t segments[TM1640Chip::GRIDS] = {}; ///< Digits of the last flush.
+    size_t flushes = 0;                       ///< Number of flushes.
+
+    /**
+     * @brief Take the digits of a flush.
+     * @param s TM1640Chip::GRIDS segment bytes.
+     * @return Number of digits taken.
+     */
+    size_t write_changed(const uint8_t *s)
+    {
+        for (size_t i = 0; i < TM1640Chip::GRIDS; ++i)
+            segments[i] = s[i];
+        ++flushes;
+        return TM1640Chip::GRIDS;
+    }
+};
+
+/**
+ * @brief set(), clear() and toggle() change one segment; get() reads it back.
+ */
+static void test_segments()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637Framebuffer fb(display);
+    for (uint8_t d = 0; d < 6; ++d)
+        CHECK_EQ(fb.segments()[d], 0);
+
+    fb.set(1, TM1637_SEG_A);
+    fb.set(1, TM1637_SEG_DP);
+    CHECK_EQ(fb.segments()[1], 0x81);
+    CHECK(fb.get(1, TM1637_SEG_A));
+    CHECK(fb.get(1, TM1637_SEG_DP));
+    CHECK(!fb.get(1, TM1637_SEG_G));
+    fb.set(1, TM1637_SEG_A); // already lit
+    CHECK_EQ(fb.segments()[1], 0x81);
+
+    fb.clear(1, TM1637_SEG_A);
+    CHECK_EQ(fb.segments()[1], 0x80);
+    fb.clear(1, TM1637_SEG_A); // already off
+    CHECK_EQ(fb.segments()[1], 0x80);
+
+    fb.toggle(4, TM1637_SEG_G);
+    CHECK_EQ(fb.segments()[4], 0x40);
+    fb.toggle(4, TM1637_SEG_G);
+    CHECK_EQ(fb.segments()[4], 0x00);
+
+    // digits past the last one are ignored
+    fb.set(6, TM1637_SEG_A);
+    fb.toggle(200, TM1637_SEG_A);
+    CHECK(!fb.get(6, TM1637_SEG_A));
+    for (uint8_t d : {0, 2, 3, 4, 5})
+        CHECK_EQ(fb.segments()[d], 0);
+
+    fb.clear_all();
+    for (uint8_t d = 0; d < 6; ++d)
+        CHECK_EQ(fb.segments()[d], 0);
+}
+
+/**
+ * @brief write() replaces only the masked bits of a digit.
+ */
+static void test_masked_write()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637Framebuffer fb(display);
+
+    fb.write(2, 0x3F); // '0'
+    CHECK_EQ(fb.segments()[2], 0x3F);
+    fb.write(2, 0x80, 0x80); // add the decimal point, keep the digit
+    CHECK_EQ(fb.segments()[2], 0xBF);
+    fb.write(2, 0x40, 0x7F); // replace the digit with '-', keep the point
+    CHECK_EQ(fb.segments()[2], 0xC0);
+    fb.write(2, 0xFF, 0x00); // empty mask
+    CHECK_EQ(fb.segments()[2], 0xC0);
+    fb.write(6, 0xFF);
+    for (uint8_t d : {0, 1, 3, 4, 5})
+        CHECK_EQ(fb.segments()[d], 0);
+}
+
+/**
+ * @brief blit() copies through the mask and clips at digit 5.
+ */
+static void test_blit()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637Framebuffer fb(display);
+    const uint8_t src[4] = {0x06, 0x5B, 0x4F, 0x66}; // "1234"
+
+    fb.blit(src, 4, 4);
+    CHECK_EQ(fb.segments()[4], 0x06);
+    CHECK_EQ(fb.segments()[5], 0x5B);
+    for (uint8_t d = 0; d < 4; ++d)
+        CHECK_EQ(fb.segments()[d], 0);
+
+    fb.blit(src, 4, 6); // starts past the end
+    fb.blit(src, 0, 0); // nothing to copy
+    for (uint8_t d = 0; d < 4; ++d)
+        CHECK_EQ(fb.segments()[d], 0);
+
+    fb.write(1, 0x80);
+    fb.blit(src, 4, 0, 0x7F); // the decimal point of digit 1 stays
+    CHECK_EQ(fb.segments()[0], 0x06);
+    CHECK_EQ(fb.segments()[1], 0xDB);
+    CHECK_EQ(fb.segments()[2], 0x4F);
+    CHECK_EQ(fb.segments()[3], 0x66);
+    CHECK_EQ(fb.segments()[4], 0x06);
+}
+
+/**
+ * @brief A flush of changes scattered over the digits takes one data transaction; an idle flush none.
+ */
+static void test_flush()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637Framebuffer fb(display);
+
+    size_t before = chip.transactions.size();
+    CHECK_EQ(fb.flush(), 0u);
+    CHECK_EQ(chip.transactions.size(), before);
+
+    fb.set(0, TM1637_SEG_A);
+    fb.toggle(5, TM1637_SEG_D);
+    fb.write(3, 0x76);
+    const uint8_t dash = 0x40;
+    fb.blit(&dash, 1, 2);
+    fb.set(1, TM1637_SEG_DP);
+    CHECK_EQ(fb.flush(), 6u);
+    // the data command, then every digit behind a single address command
+    CHECK_EQ(chip.transactions.size(), before + 2);
+    CHECK_EQ(chip.transactions[before].size(), 1u);
+    CHECK_EQ(chip.transactions[before][0], TM1637_CMD1);
+    CHECK_EQ(chip.transactions[before + 1].size(), 7u);
+    CHECK_EQ(chip.transactions[before + 1][0], TM1637_CMD2);
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], fb.segments()[TM1637Chip::digit_at(addr)]);
+
+    // changes within one wiring group only send that group's span
+    before = chip.transactions.size();
+    fb.clear(0, TM1637_SEG_A);
+    fb.toggle(2, TM1637_SEG_G);
+    CHECK_EQ(fb.flush(), 3u);
+    CHECK_EQ(chip.transactions.size(), before + 2);
+    CHECK_EQ(chip.transactions[before + 1].size(), 4u);
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], fb.segments()[TM1637Chip::digit_at(addr)]);
+
+    before = chip.transactions.size();
+    CHECK_EQ(fb.flush(), 0u);
+    CHECK_EQ(chip.transactions.size(), before);
+}
+
+/**
+ * @brief The template follows the grid count of its chip descriptor.
+ */
+static void test_other_chip()
+{
+    RecordingDisplay display;
+    TM16xxFramebuffer<TM1640Chip, RecordingDisplay> fb(display);
+    const uint8_t src[4] = {0x06, 0x5B, 0x4F, 0x66};
+    fb.blit(src, 4, 14); // clipped at digit 15
+    fb.set(15, TM16XX_SEG_DP);
+    fb.set(16, TM16XX_SEG_G);
+    CHECK_EQ(fb.flush(), 16u);
+    CHECK_EQ(display.flushes, 1u);
+    CHECK_EQ(display.segments[14], 0x06);
+    CHECK_EQ(display.segments[15], 0xDB);
+    for (uint8_t d = 0; d < 14; ++d)
+        CHECK_EQ(display.segments[d], 0);
+}
+
+int main()
+{
+    test_segments();
+    test_masked_write();
+    test_blit();
+    test_flush();
+    test_other_chip();
+    return check_result();
+}
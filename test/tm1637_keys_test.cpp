@@ -0,0 +1,142 @@
+/**
+ * @file tm1637_keys_test.cpp
+ * @brief Host test of key-scan reading through the bit-banged bus and the TM1637Keypad debouncer.
+ *
+ * The virtual chip shifts its key code out on the falling CLK edges, so
+ * read_key() exercises the real _read_byte() sampling; poll_keys() then
+ * feeds the codes into the debouncer at simulated times.
+ */
+#include "tm1637.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+#include <vector>
+
+const uint CLK = 2;
+const uint DIO = 3;
+
+/**
+ * @brief Every key code the chip can report is read back and decoded.
+ */
+static void test_read_codes()
+{
+    TM1637Model chip(CLK, DIO);
+    TM1637 display(CLK, DIO);
+
+    CHECK_EQ(display.read_key(), 0xFF);
+    CHECK_EQ(TM1637Keypad::decode(0xFF), -1);
+    // K1 with SG1..SG8 reads 0xF7..0xF0, K2 with SG1..SG8 reads 0xEF..0xE8
+    for (int key = 0; key < 16; ++key)
+    {
+        uint8_t code = uint8_t((key < 8 ? 0xF7 : 0xEF) - (key & 7));
+        chip.key = code;
+        uint8_t read = display.read_key();
+        CHECK_EQ(read, code);
+        CHECK_EQ(TM1637Keypad::decode(read), key);
+    }
+    // the chip only received the read command, the display was left alone
+    CHECK(!chip.transactions.empty());
+    CHECK_EQ(chip.transactions.back().size(), 1u);
+    CHECK_EQ(chip.transactions.back()[0], TM1637_CMD1 | TM1637_READ_KEYS);
+}
+
+/**
+ * @brief Test fixture scanning the keys of a virtual chip at chosen times.
+ */
+struct Scanner
+{
+    TM1637Model chip{CLK, DIO};
+    TM1637 display{CLK, DIO};
+    TM1637Keypad keypad{20000, 500000, 100000};
+
+    Scanner() { display.attach_keypad(&keypad, 10000); }
+
+    /**
+     * @brief Scan every 10 ms from the current time up to until_us with a code held.
+     */
+    void hold(uint8_t code, uint64_t until_us)
+    {
+        chip.key = code;
+        for (uint64_t t = now_; t < until_us; t += 10000)
+        {
+            host_set_time_us(t);
+            display.poll_keys();
+        }
+        now_ = until_us;
+    }
+
+    /**
+     * @brief Take all pending events.
+     */
+    std::vector<TM1637KeyEvent> events()
+    {
+        std::vector<TM1637KeyEvent> out;
+        TM1637KeyEvent event;
+        while (keypad.next(event))
+            out.push_back(event);
+        return out;
+    }
+
+    uint64_t now_ = 1000000;
+};
+
+/**
+ * @brief Press, hold with auto-repeat, release; a short glitch is filtered out.
+ */
+static void test_debounce_repeat()
+{
+    Scanner s;
+    s.hold(0xFF, 1100000);
+    CHECK(s.events().empty());
+
+    // a 10 ms glitch on K2/SG3 does not pass the 20 ms debounce
+    s.hold(0xED, 1110000);
+    s.hold(0xFF, 1200000);
+    CHECK(s.events().empty());
+
+    // K1/SG2 held for 800 ms: press after the debounce, repeats from 500 ms every 100 ms
+    s.hold(0xF6, 2000000);
+    std::vector<TM1637KeyEvent> events = s.events();
+    CHECK_EQ(events.size(), 4u);
+    if (events.size() == 4)
+    {
+        CHECK_EQ(events[0].action, TM1637_KEY_PRESS);
+        CHECK(events[0].time_us >= 1220000 && events[0].time_us < 1240000);
+        for (size_t i = 1; i < 4; ++i)
+        {
+            CHECK_EQ(events[i].action, TM1637_KEY_REPEAT);
+            CHECK_EQ(events[i].key, 1);
+        }
+        CHECK(events[1].time_us >= events[0].time_us + 500000);
+        CHECK(events[2].time_us >= events[1].time_us + 100000);
+    }
+
+    s.hold(0xFF, 2100000);
+    events = s.events();
+    CHECK_EQ(events.size(), 1u);
+    if (!events.empty())
+    {
+        CHECK_EQ(events[0].action, TM1637_KEY_RELEASE);
+        CHECK_EQ(events[0].key, 1);
+    }
+
+    // going straight from one key to another releases the first
+    s.hold(0xE8, 2200000);
+    s.hold(0xF0, 2300000);
+    events = s.events();
+    CHECK_EQ(events.size(), 3u);
+    if (events.size() == 3)
+    {
+        CHECK(events[0].action == TM1637_KEY_PRESS && events[0].key == 15);
+        CHECK(events[1].action == TM1637_KEY_RELEASE && events[1].key == 15);
+        CHECK(events[2].action == TM1637_KEY_PRESS && events[2].key == 7);
+    }
+    CHECK_EQ(s.keypad.dropped(), 0u);
+}
+
+int main()
+{
+    test_read_codes();
+    test_debounce_repeat();
+    return check_result();
+}
@@ -0,0 +1,182 @@
+/**
+ * @file tm1637_link_test.cpp
+ * @brief Host test of the link receiver and a pipe loopback throughput measurement.
+ *
+ * The loopback writes encoded frames into a pipe from a second thread while
+ * the main loop runs TM1637LinkReceiver::poll() and TM1637Manager::service(),
+ * with getchar_timeout_us() reading the other end of the pipe. Every frame
+ * is written to a virtual chip on the simulated bus, so frames/s measures
+ * the parsing, scheduling and driver work on the host CPU, not bus time.
+ */
+#include "tm1637_link_rx.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @brief A brightness attribute is queued with the frame; only service() uses the bus.
+ */
+static void test_brightness_queued()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3, 7);
+    TM1637Manager manager;
+    int id = manager.add(display);
+    TM1637LinkReceiver link(manager);
+
+    uint8_t frame[TM1637_LINK_MAX_FRAME];
+    size_t n = tm1637_link_encode_text(frame, uint8_t(id), "12.3456", 7, tm1637_link_attributes(2, 3));
+    size_t bus_before = chip.transactions.size();
+    CHECK_EQ(link.feed(frame, n), 1u);
+    CHECK_EQ(chip.transactions.size(), bus_before);
+    CHECK(manager.pending());
+
+    CHECK(manager.service());
+    CHECK(!manager.pending());
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 3);
+    Segments expected = display.encode_string("12.3456");
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], expected[TM1637Chip::digit_at(addr)]);
+    CHECK_EQ(manager.stats(id).frames, 1u);
+
+    // a brightness-only frame takes one service() call
+    n = tm1637_link_encode(frame, uint8_t(id), nullptr, 0, 0, tm1637_link_attributes(0, 6));
+    CHECK_EQ(link.feed(frame, n), 1u);
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 3);
+    CHECK(manager.service());
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 6);
+    CHECK(!manager.service());
+
+    // the same brightness again is not re-queued
+    CHECK_EQ(link.feed(frame, n), 1u);
+    CHECK(!manager.pending());
+
+    // a corrupted frame is dropped
+    frame[n - 1] ^= 0x01;
+    CHECK_EQ(link.feed(frame, n), 0u);
+    CHECK_EQ(link.stats().errors, 1u);
+}
+
+/**
+ * @brief A sync byte in line noise does not swallow the frame behind it.
+ */
+static void test_resync_after_noise()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3, 7);
+    TM1637Manager manager;
+    int id = manager.add(display);
+    TM1637LinkReceiver link(manager);
+
+    const uint8_t noises[][4] = {
+        {0x13, TM1637_LINK_SYNC, 0x01, 0x02}, // the frame's sync is taken as the count byte
+        {0x00, 0x00, 0x00, TM1637_LINK_SYNC}, // the frame's sync is taken as the display id
+        {TM1637_LINK_SYNC, 0x00, 0x00, 0x0F}, // count out of range
+    };
+    char text[] = "12.3456";
+    for (size_t k = 0; k < 3; ++k)
+    {
+        for (size_t step : {size_t(1), sizeof(noises[k]) + TM1637_LINK_MAX_FRAME})
+        {
+            text[0] = char('1' + k);
+            text[3] = char(step == 1 ? '3' : '4');
+            uint8_t stream[sizeof(noises[k]) + TM1637_LINK_MAX_FRAME];
+            std::memcpy(stream, noises[k], sizeof(noises[k]));
+            size_t n = sizeof(noises[k]) +
+                       tm1637_link_encode_text(stream + sizeof(noises[k]), uint8_t(id), text, 7);
+            uint32_t errors = link.stats().errors;
+
+            // in one call, and one byte per call
+            size_t frames = 0;
+            for (size_t i = 0; i < n; i += step)
+                frames += link.feed(stream + i, std::min(step, n - i));
+            CHECK_EQ(frames, 1u);
+            CHECK_EQ(link.stats().errors, errors + 1);
+
+            CHECK(manager.service());
+            Segments expected = display.encode_string(text);
+            for (size_t addr = 0; addr < 6; ++addr)
+                CHECK_EQ(chip.ram[addr], expected[TM1637Chip::digit_at(addr)]);
+        }
+    }
+}
+
+/**
+ * @brief Stream frames for two displays through a pipe and report frames/s.
+ * @param frames Number of frames to send.
+ */
+static void test_pipe_loopback(size_t frames)
+{
+    TM1637Model chip_a(2, 3);
+    TM1637Model chip_b(4, 5);
+    TM1637 a(2, 3);
+    TM1637 b(4, 5);
+    TM1637Manager manager;
+    manager.add(a);
+    manager.add(b);
+    TM1637LinkReceiver link(manager);
+
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        CHECK(false);
+        return;
+    }
+    host_set_stdin(fds[0]);
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread writer([&]()
+                       {
+                           uint8_t frame[TM1637_LINK_MAX_FRAME];
+                           char text[8];
+                           for (size_t i = 0; i < frames; ++i)
+                           {
+                               std::snprintf(text, sizeof(text), "%06zu", i % 1000000);
+                               size_t n = tm1637_link_encode_text(frame, uint8_t(i & 1), text, 6);
+                               if (write(fds[1], frame, n) != ssize_t(n))
+                                   break;
+                           }
+                       });
+
+    size_t received = 0;
+    while (received < frames)
+    {
+        received += link.poll();
+        while (manager.service())
+            ;
+    }
+    writer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    host_set_stdin(-1);
+    close(fds[0]);
+    close(fds[1]);
+
+    CHECK_EQ(link.stats().frames, frames);
+    CHECK_EQ(link.stats().errors, 0u);
+    CHECK_EQ(link.stats().skipped, 0u);
+    // the last frame of each display is on its chip
+    char last[8];
+    std::snprintf(last, sizeof(last), "%06zu", (frames - 1) % 1000000);
+    Segments expected = b.encode_string(last);
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(((frames - 1) & 1 ? chip_b : chip_a).ram[addr], expected[TM1637Chip::digit_at(addr)]);
+    // frames arriving faster than the bus takes them are coalesced per display
+    std::printf("pipe loopback\t%zu frames\t%.0f frames/s\t%u written\t%u coalesced\n", frames, frames / seconds,
+                unsigned(manager.stats(0).frames + manager.stats(1).frames),
+                unsigned(manager.stats(0).coalesced + manager.stats(1).coalesced));
+}
+
+int main(int argc, char **argv)
+{
+    size_t frames = argc > 1 ? size_t(std::strtoul(argv[1], nullptr, 10)) : 100000;
+    test_brightness_queued();
+    test_resync_after_noise();
+    test_pipe_loopback(frames);
+    return check_result();
+}
@@ -0,0 +1,59 @@
+/**
+ * @file tm1637_manager_test.cpp
+ * @brief Host test of TM1637Manager scheduling two bit-banged displays on virtual chips.
+ */
+#include "tm1637_manager.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+/**
+ * @brief A coalesced frame keeps the highest priority it was posted with.
+ */
+static void test_coalesced_priority()
+{
+    TM1637Model chip_a(2, 3);
+    TM1637Model chip_b(4, 5);
+    TM1637 a(2, 3);
+    TM1637 b(4, 5);
+    TM1637Manager manager;
+    int id_a = manager.add(a);
+    int id_b = manager.add(b);
+
+    manager.post(id_a, a.encode_string("AAAAAA"), 3);
+    manager.post(id_b, b.encode_string("bbbbbb"), 1);
+    // a low-priority refresh replaces the content but must not demote the frame
+    manager.post(id_a, a.encode_string("111111"), 0);
+    size_t before_b = chip_b.transactions.size();
+
+    CHECK(manager.service());
+    CHECK_EQ(chip_b.transactions.size(), before_b);
+    CHECK_EQ(chip_a.ram[0], a.encode_char('1'));
+    CHECK_EQ(manager.stats(id_a).coalesced, 1u);
+
+    CHECK(manager.service());
+    CHECK(chip_b.transactions.size() > before_b);
+    CHECK(!manager.service());
+}
+
+/**
+ * @brief Unknown ids are rejected everywhere.
+ */
+static void test_unknown_ids()
+{
+    TM1637 a(2, 3);
+    TM1637Manager manager;
+    int id = manager.add(a);
+    CHECK(!manager.post(id + 1, Segments{}));
+    CHECK(!manager.post(-1, Segments{}));
+    CHECK(manager.display(id + 1) == nullptr);
+    CHECK_EQ(manager.stats(id + 1).frames, 0u);
+    CHECK_EQ(manager.stats(-1).coalesced, 0u);
+    CHECK_EQ(manager.stats(TM1637Manager::MAX_DISPLAYS).max_latency_us, 0u);
+}
+
+int main()
+{
+    test_coalesced_priority();
+    test_unknown_ids();
+    return check_result();
+}
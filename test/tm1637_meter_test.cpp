@@ -0,0 +1,207 @@
+/**
+ * @file tm1637_meter_test.cpp
+ * @brief Host test of TM1637LevelMeter: bar steps, rounding, peak hold and decay on a virtual chip.
+ *
+ * update() reads time_us_32() once, so every update is preceded by
+ * host_set_time_us() to place it exactly on the simulated clock.
+ */
+#include "tm1637_meter.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+/**
+ * @brief Segments of the three steps of a digit: e/f, g, b/c.
+ */
+static const uint8_t STEP[TM1637LevelMeter::STEPS_PER_DIGIT] = {0x30, 0x40, 0x06};
+
+/**
+ * @brief Check the chip RAM against a bar and a peak marker.
+ * @param chip The virtual chip.
+ * @param level Steps lit by the bar.
+ * @param peak Step count up to and including the peak marker, 0 for none.
+ * @param first First digit of the meter.
+ * @param digits Number of digits the meter spans.
+ */
+static void check_meter(const TM1637Model &chip, uint8_t level, uint8_t peak, uint8_t first = 0,
+                        uint8_t digits = 6)
+{
+    uint8_t expected[TM1637Chip::GRIDS] = {};
+    for (uint8_t step = 0; step < digits * TM1637LevelMeter::STEPS_PER_DIGIT; ++step)
+        if ((step < level) || (step + 1 == peak))
+            expected[first + step / 3] |= STEP[step % 3];
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], expected[TM1637Chip::digit_at(addr)]);
+}
+
+/**
+ * @brief Every level lights its steps left to right, e/f then g then b/c per digit.
+ */
+static void test_steps()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637LevelMeter meter(display);
+    meter.set_peak(0, 0);
+    CHECK_EQ(meter.steps(), 18u);
+    for (uint8_t level = 0; level <= 18; ++level)
+    {
+        meter.update(level, 18);
+        check_meter(chip, level, 0);
+    }
+
+    // a meter over digits 2 and 3 leaves the others blank
+    TM1637Model part_chip(4, 5);
+    TM1637 part_display(4, 5);
+    TM1637LevelMeter part(part_display, 2, 2);
+    part.set_peak(0, 0);
+    CHECK_EQ(part.steps(), 6u);
+    part.update(4, 6);
+    check_meter(part_chip, 4, 0, 2, 2);
+    part.update(100, 6); // clipped to full scale
+    check_meter(part_chip, 6, 0, 2, 2);
+}
+
+/**
+ * @brief Values round to the nearest step; a zero full scale shows nothing.
+ */
+static void test_rounding()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637LevelMeter meter(display);
+    meter.set_peak(0, 0);
+
+    // one step is 1000/18 = 55.6: half a step is 27.8
+    meter.update(27, 1000);
+    check_meter(chip, 0, 0);
+    meter.update(28, 1000);
+    check_meter(chip, 1, 0);
+    meter.update(83, 1000); // 1.49 steps
+    check_meter(chip, 1, 0);
+    meter.update(84, 1000); // 1.51 steps
+    check_meter(chip, 2, 0);
+    meter.update(972, 1000); // 17.496 steps
+    check_meter(chip, 17, 0);
+    meter.update(973, 1000);
+    check_meter(chip, 18, 0);
+    meter.update(5, 0);
+    check_meter(chip, 0, 0);
+}
+
+/**
+ * @brief The peak holds for hold_us, falls by the steps due per decay_us and never below the bar.
+ */
+static void test_peak()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637LevelMeter meter(display);
+    meter.set_peak(1000000, 100000);
+
+    host_set_time_us(0);
+    meter.update(12, 18);
+    check_meter(chip, 12, 12);
+    host_set_time_us(1000);
+    meter.update(3, 18);
+    check_meter(chip, 3, 12);
+
+    // held until hold_us after it was set
+    host_set_time_us(999999);
+    meter.update(3, 18);
+    check_meter(chip, 3, 12);
+    host_set_time_us(1000000);
+    meter.update(3, 18);
+    check_meter(chip, 3, 12);
+
+    // then one step per decay_us, counted from the end of the hold
+    host_set_time_us(1099999);
+    meter.update(3, 18);
+    check_meter(chip, 3, 12);
+    host_set_time_us(1100000);
+    meter.update(3, 18);
+    check_meter(chip, 3, 11);
+
+    // a late update takes every step that fell due, and keeps the remainder
+    host_set_time_us(1350000);
+    meter.update(3, 18);
+    check_meter(chip, 3, 9);
+    host_set_time_us(1400000);
+    meter.update(3, 18);
+    check_meter(chip, 3, 8);
+
+    // the fall stops at the bar: 16 steps were due, the peak stays at 5 and
+    // shows once the bar drops below it
+    host_set_time_us(3000000);
+    meter.update(5, 18);
+    check_meter(chip, 5, 5);
+    host_set_time_us(3050000);
+    meter.update(2, 18);
+    check_meter(chip, 2, 5);
+
+    // a higher level sets a new peak and restarts the hold
+    host_set_time_us(5000000);
+    meter.update(9, 18);
+    host_set_time_us(5001000);
+    meter.update(2, 18);
+    check_meter(chip, 2, 9);
+    host_set_time_us(5999999);
+    meter.update(2, 18);
+    check_meter(chip, 2, 9);
+}
+
+/**
+ * @brief hold_us 0 disables the marker.
+ */
+static void test_no_peak()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637LevelMeter meter(display);
+    meter.set_peak(0, 100000);
+
+    host_set_time_us(0);
+    meter.update(12, 18);
+    host_set_time_us(1000);
+    meter.update(3, 18);
+    check_meter(chip, 3, 0);
+    host_set_time_us(2000000);
+    meter.update(3, 18);
+    check_meter(chip, 3, 0);
+}
+
+/**
+ * @brief Only changed digits are sent; an unchanged level costs no bus time.
+ */
+static void test_unchanged()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637LevelMeter meter(display);
+    meter.set_peak(0, 0);
+
+    CHECK_EQ(meter.update(18, 18), 6u);
+    size_t before = chip.transactions.size();
+    CHECK_EQ(meter.update(18, 18), 0u);
+    CHECK_EQ(chip.transactions.size(), before);
+
+    // a value in the same step renders the same segments
+    meter.update(10, 18);
+    before = chip.transactions.size();
+    CHECK_EQ(meter.update(10, 18), 0u);
+    CHECK_EQ(meter.update(1000, 1800), 0u);
+    CHECK_EQ(chip.transactions.size(), before);
+
+    // one step more only touches the digit it lands in
+    CHECK_EQ(meter.update(11, 18), 1u);
+    check_meter(chip, 11, 0);
+}
+
+int main()
+{
+    test_steps();
+    test_rounding();
+    test_peak();
+    test_no_peak();
+    test_unchanged();
+    return check_result();
+}
@@ -0,0 +1,140 @@
+/**
+ * @file tm1637_model.cpp
+ * @brief Implementation of the virtual TM1637.
+ */
+#include "tm1637_model.hpp"
+
+/**
+ * @brief Attach a virtual chip to two lines.
+ * @param clk Pin number of the clock (CLK) line.
+ * @param dio Pin number of the data (DIO) line.
+ */
+TM1637Model::TM1637Model(uint clk, uint dio)
+    : clk_(1u << clk), dio_(1u << dio)
+{
+    host_attach(this);
+}
+
+/**
+ * @brief Detach the chip from the lines.
+ */
+TM1637Model::~TM1637Model()
+{
+    host_detach(this);
+}
+
+/**
+ * @brief Follow the line levels.
+ * @param level Bit mask of the lines that are high.
+ */
+void TM1637Model::lines(uint32_t level)
+{
+    bool clk = (level & clk_) != 0;
+    bool dio = (level & dio_) != 0;
+    if (clk != clk_high_)
+    {
+        uint64_t now = host_time_us();
+        if (now - clk_edge_us_ < min_half_us)
+            too_fast_ = true;
+        clk_edge_us_ = now;
+    }
+    if (clk && clk_high_ && (dio != dio_high_))
+    {
+        if (!dio)
+        {
+            // start
+            active_ = true;
+            too_fast_ = false;
+            bit_ = 0;
+            shift_ = 0;
+            reading_ = read_next_ = false;
+            addr_set_ = false;
+            tx_.clear();
+        }
+        else if (active_)
+        {
+            // stop
+            active_ = false;
+            reading_ = false;
+            transactions.push_back(tx_);
+        }
+    }
+    else if (active_ && clk && !clk_high_)
+    {
+        if ((bit_ < 8) && !reading_ && dio)
+            shift_ |= uint8_t(1u << bit_);
+        ++bit_;
+    }
+    else if (active_ && !clk && clk_high_)
+    {
+        if (bit_ == 8)
+        {
+            // a written byte is acknowledged, a read one is acknowledged by the host
+            pull_ = reading_ ? false : _byte(shift_);
+        }
+        else if (bit_ == 9)
+        {
+            pull_ = false;
+            bit_ = 0;
+            shift_ = 0;
+            reading_ = read_next_;
+            read_next_ = false;
+            if (reading_)
+                pull_ = !(key & 1u);
+        }
+        else if (reading_)
+        {
+            pull_ = !((key >> bit_) & 1u);
+        }
+    }
+    clk_high_ = clk;
+    dio_high_ = dio;
+}
+
+/**
+ * @brief Get the lines the chip pulls low.
+ * @return The DIO mask while acknowledging or sending a 0 bit.
+ */
+uint32_t TM1637Model::pulls() const
+{
+    return pull_ ? dio_ : 0;
+}
+
+/**
+ * @brief Process a received byte.
+ * @return true if the byte is acknowledged.
+ */
+bool TM1637Model::_byte(uint8_t b)
+{
+    ++bytes;
+    tx_.push_back(b);
+    bool too_fast = too_fast_;
+    too_fast_ = false;
+    if (too_fast || (nack_every && (bytes % nack_every == 0)))
+        return false;
+    if (tx_.size() == 1)
+    {
+        switch (b & 0xC0)
+        {
+        case 0x40: // data command
+            fixed_ = (b & 0x04) != 0;
+            read_next_ = (b & 0x02) != 0;
+            break;
+        case 0xC0: // address command
+            addr_ = b & 0x0F;
+            addr_set_ = true;
+            break;
+        case 0x80: // display control
+            ctrl = b;
+            break;
+        }
+    }
+    else if (addr_set_)
+    {
+        if (addr_ < sizeof(ram))
+            ram[addr_] = b;
+        if (!fixed_)
+            ++addr_;
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file tm1637_model.hpp
+ * @brief Virtual TM1637 on the simulated GPIO lines of the host tests.
+ *
+ * The model follows the bus like the chip: start and stop conditions are
+ * DIO edges while CLK is high, bits are sampled on rising CLK edges LSB
+ * first, and every byte is acknowledged by pulling DIO low from the
+ * falling edge of its 8th clock to the falling edge of the 9th. After a
+ * read command (0x42) it shifts the key code out on the falling edges.
+ * A byte clocked with a CLK edge sooner than min_half_us after the
+ * previous one is not acknowledged, like a chip behind a slow cable.
+ */
+
+#ifndef TM1637_MODEL_HPP
+#define TM1637_MODEL_HPP
+
+#include "host_pico.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class TM1637Model
+ * @brief Virtual TM1637 keeping the display RAM, control byte and bus log.
+ */
+class TM1637Model : public HostGpioDevice
+{
+public:
+    /**
+     * @brief Attach a virtual chip to two lines.
+     * @param clk Pin number of the clock (CLK) line.
+     * @param dio Pin number of the data (DIO) line.
+     */
+    TM1637Model(uint clk, uint dio);
+
+    /**
+     * @brief Detach the chip from the lines.
+     */
+    ~TM1637Model() override;
+
+    void lines(uint32_t level) override;
+    uint32_t pulls() const override;
+
+    uint8_t ram[6] = {};                           ///< Display RAM by grid address.
+    uint8_t ctrl = 0;                              ///< Last display control byte.
+    uint8_t key = 0xFF;                            ///< Key-scan code returned by reads.
+    size_t nack_every = 0;                         ///< Leave every n-th byte unacknowledged, 0 for none.
+    uint64_t min_half_us = 0;                      ///< Shortest CLK half period the chip follows (us).
+    size_t bytes = 0;                              ///< Bytes received.
+    std::vector<std::vector<uint8_t>> transactions; ///< Bytes of every completed transaction.
+
+private:
+    /**
+     * @brief Process a received byte.
+     * @return true if the byte is acknowledged.
+     */
+    bool _byte(uint8_t b);
+
+    uint32_t clk_;               ///< CLK pin mask.
+    uint32_t dio_;               ///< DIO pin mask.
+    bool clk_high_ = true;       ///< CLK level seen last.
+    uint64_t clk_edge_us_ = 0;   ///< Time of the last CLK edge.
+    bool too_fast_ = false;      ///< The current byte had a CLK half period below min_half_us.
+    bool dio_high_ = true;       ///< DIO level seen last.
+    bool active_ = false;        ///< Between start and stop.
+    int bit_ = 0;                ///< Rising edges of the current byte.
+    uint8_t shift_ = 0;          ///< Bits of the current byte.
+    bool pull_ = false;          ///< Pulling DIO low.
+    bool read_next_ = false;     ///< The acknowledged byte was a read command.
+    bool reading_ = false;       ///< Shifting the key code out.
+    bool fixed_ = false;         ///< Fixed address mode.
+    size_t addr_ = 0;            ///< Next display RAM address.
+    bool addr_set_ = false;      ///< An address command opened the transaction.
+    std::vector<uint8_t> tx_;    ///< Bytes of the current transaction.
+};
+
+#endif // TM1637_MODEL_HPP
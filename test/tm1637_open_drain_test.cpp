@@ -0,0 +1,72 @@
+/**
+ * @file tm1637_open_drain_test.cpp
+ * @brief Host test of the TM1637_OPEN_DRAIN bus against the virtual chip.
+ *
+ * In open-drain mode the driver may only pull the lines low; every high
+ * level has to come from the pull-ups. A probe on the lines flags any
+ * moment the host drives CLK or DIO high, and the GPIO model counts every
+ * time the host drives a line against the chip pulling it low.
+ */
+#include "tm1637.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+const uint CLK = 2;
+const uint DIO = 3;
+
+/**
+ * @class DriveProbe
+ * @brief Passive device flagging lines driven high by the host.
+ */
+class DriveProbe : public HostGpioDevice
+{
+public:
+    DriveProbe() { host_attach(this); }
+    ~DriveProbe() override { host_detach(this); }
+
+    void lines(uint32_t level) override { driven_high |= host_driven() & level & ((1u << CLK) | (1u << DIO)); }
+    uint32_t pulls() const override { return 0; }
+
+    uint32_t driven_high = 0; ///< Lines seen driven high by the host.
+};
+
+/**
+ * @brief Writes, key reads, retries and calibration never drive a line high.
+ */
+static void test_never_drives_high()
+{
+    TM1637Model chip(CLK, DIO);
+    DriveProbe probe;
+    TM1637 display(CLK, DIO, 6);
+
+    display.write(display.encode_string("8.8.8.8.8.8."));
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], 0xFF);
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 6);
+
+    // the chip drives DIO while it shifts a key code out
+    chip.key = 0xEA;
+    CHECK_EQ(display.read_key(), 0xEA);
+
+    // NACKs, recovery clocks and the resend
+    display.set_retry_policy(1, 10);
+    chip.nack_every = 3;
+    display.write(display.encode_string("123456"));
+    chip.nack_every = 0;
+    CHECK(display.repair());
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], display.encode_string("123456")[TM1637Chip::digit_at(addr)]);
+
+    display.calibrate(25, 2);
+    CHECK(display.bus_delay() >= 1);
+
+    CHECK_EQ(probe.driven_high, 0u);
+    CHECK_EQ(host_contention(), 0u);
+    CHECK_EQ(host_lines() & ((1u << CLK) | (1u << DIO)), (1u << CLK) | (1u << DIO)); // bus idles high
+}
+
+int main()
+{
+    test_never_drives_high();
+    return check_result();
+}
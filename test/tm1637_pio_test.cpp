@@ -0,0 +1,149 @@
+/**
+ * @file tm1637_pio_test.cpp
+ * @brief Host test of the PIO transmitter: FIFO word packing and the bus waveform of tm1637.pio.
+ *
+ * The words the driver pushes are checked bit by bit, then replayed by the
+ * host model of the program onto the virtual chip, which has to decode the
+ * same transactions as from the bit-banged bus.
+ */
+#include "tm1637.hpp"
+#include "tm1637.pio.h"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+#include <fstream>
+#include <string>
+
+const uint CLK = 2;
+const uint DIO = 3;
+
+/**
+ * @brief Build the FIFO word the driver should push for one byte.
+ */
+static uint32_t word(uint8_t b, bool start, bool stop)
+{
+    return (start ? 1u : 0u) | (uint32_t(b) << 1) | (stop ? 1u << 9 : 0u) | (1u << 10);
+}
+
+/**
+ * @brief Check the word layout: start bit 0, data bits 1-8, stop bit 9, pending marker bit 10.
+ */
+static void test_packing()
+{
+    TM1637 display(CLK, DIO, pio0, 0, 5);
+    std::vector<uint32_t> &words = host_pio_words(pio0, 0);
+    // data command, address + 6 digits (the last one carries the stop), display control
+    auto frame = [](const uint8_t *ram)
+    {
+        std::vector<uint32_t> expected = {word(TM1637_CMD1, true, true), word(TM1637_CMD2, true, false)};
+        for (size_t i = 0; i < 6; ++i)
+            expected.push_back(word(ram[i], false, i == 5));
+        expected.push_back(word(TM1637_CMD3 | TM1637_DSP_ON | 5, true, true));
+        return expected;
+    };
+    // the constructor clears the display RAM
+    const uint8_t zeros[6] = {};
+    CHECK(words == frame(zeros));
+
+    words.clear();
+    display.write({0x01, 0x02, 0x03, 0x04, 0x05, 0x06});
+    const uint8_t ram[] = {0x03, 0x02, 0x01, 0x06, 0x05, 0x04};
+    CHECK(words == frame(ram));
+    for (uint32_t w : words)
+        CHECK_EQ(w >> 11, 0u); // nothing above the marker
+}
+
+/**
+ * @brief Replay the program model onto the virtual chip and check the waveform timing.
+ */
+static void test_waveform()
+{
+    TM1637Model bitbang_chip(CLK, DIO);
+    {
+        TM1637 bitbang(CLK, DIO, 3);
+        bitbang.write(bitbang.encode_string("8.8.8.8.8.8."));
+    }
+    std::vector<std::vector<uint8_t>> expected = bitbang_chip.transactions;
+
+    const uint PIO_CLK = 6;
+    const uint PIO_DIO = 7;
+    TM1637Model chip(PIO_CLK, PIO_DIO);
+    std::vector<HostPioStep> &trace = host_pio_trace(pio0, 1);
+    TM1637 display(PIO_CLK, PIO_DIO, pio0, 1, 3);
+    display.write(display.encode_string("8.8.8.8.8.8."));
+
+    // same transactions as the bit-banged bus, acknowledged by the chip
+    CHECK(chip.transactions == expected);
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 3);
+    for (size_t i = 0; i < 6; ++i)
+        CHECK_EQ(chip.ram[i], 0xFF);
+
+    // every bus step holds for 8 cycles; DIO only changes while CLK is high
+    // for a start (falling) or stop (rising), and is released for the ACK
+    size_t starts = 0, stops = 0, acks = 0;
+    int clk_pulses = 0;
+    for (size_t i = 1; i < trace.size(); ++i)
+    {
+        const HostPioStep &prev = trace[i - 1];
+        const HostPioStep &cur = trace[i];
+        if (cur.clk != prev.clk)
+        {
+            // the previous level held for a full step
+            size_t j = i - 1;
+            while ((j > 0) && (trace[j - 1].clk == prev.clk))
+                --j;
+            CHECK(cur.cycle - trace[j].cycle >= 8);
+            if (cur.clk)
+            {
+                ++clk_pulses;
+                if (!cur.dio_out)
+                    ++acks;
+            }
+        }
+        else if (cur.clk && prev.clk && (cur.dio != prev.dio))
+        {
+            cur.dio ? ++stops : ++starts;
+            CHECK(cur.cycle - prev.cycle >= 8);
+        }
+    }
+    // constructor (clearing the RAM) and write(): 3 transactions, 9 bytes each
+    CHECK_EQ(starts, 6u);
+    CHECK_EQ(stops, 6u);
+    CHECK_EQ(acks, 18u);                 // one ACK slot per byte
+    CHECK_EQ(clk_pulses, 18 * 9 + 6);    // 9 clocks per byte, plus the CLK rise of each stop
+}
+
+/**
+ * @brief Check the program length of the host model against the instructions in tm1637.pio.
+ */
+static void test_program_length()
+{
+    std::ifstream pio(TM1637_PIO_SOURCE);
+    CHECK(pio.good());
+    int instructions = 0;
+    bool in_program = false;
+    std::string line;
+    while (std::getline(pio, line))
+    {
+        line = line.substr(0, line.find(';'));
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos)
+            continue;
+        line = line.substr(first, line.find_last_not_of(" \t\r") + 1 - first);
+        if (line.rfind(".program", 0) == 0)
+            in_program = true;
+        else if (line[0] == '%')
+            in_program = false;
+        else if (in_program && (line[0] != '.') && (line.back() != ':'))
+            ++instructions; // directives and labels take no instruction slot
+    }
+    CHECK_EQ(tm1637_program.length, instructions);
+}
+
+int main()
+{
+    test_packing();
+    test_waveform();
+    test_program_length();
+    return check_result();
+}
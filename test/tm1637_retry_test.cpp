@@ -0,0 +1,81 @@
+/**
+ * @file tm1637_retry_test.cpp
+ * @brief Host test of the NACK retry policy and the display RAM shadow resend.
+ */
+#include "tm1637.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+/**
+ * @brief A write that fails all retries makes exactly max_retries + 1 attempts.
+ */
+static void test_give_up()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    display.set_retry_policy(2, 100);
+    display.reset_stats();
+
+    chip.nack_every = 1;
+    display.write(display.encode_string("123456"));
+    CHECK_EQ(display.stats().nacks, 3u);
+    CHECK_EQ(display.stats().retries, 2u);
+    CHECK_EQ(display.stats().failures, 1u);
+    // the resend is left to the next operation instead of retrying all over again
+    CHECK_EQ(display.stats().resends, 0u);
+
+    display.brightness(3);
+    CHECK_EQ(display.stats().nacks, 6u);
+    CHECK_EQ(display.stats().failures, 2u);
+    CHECK_EQ(display.stats().resends, 0u);
+}
+
+/**
+ * @brief Once the chip answers again, the next operation re-sends the shadow.
+ */
+static void test_resend_after_failure()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    display.set_retry_policy(1, 100);
+    display.write(display.encode_string("111111"));
+
+    chip.nack_every = 1;
+    display.write(display.encode_string("222222"));
+    chip.nack_every = 0;
+    display.reset_stats();
+
+    display.brightness(5);
+    CHECK_EQ(display.stats().nacks, 0u);
+    CHECK_EQ(display.stats().resends, 1u);
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], display.encode_char('2'));
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 5);
+}
+
+/**
+ * @brief The doubling backoff stops at TM1637_MAX_BACKOFF_US, even past 64 retries.
+ */
+static void test_backoff_cap()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    display.set_retry_policy(80, 100);
+    display.reset_stats();
+
+    chip.nack_every = 1;
+    display.write(display.encode_string("123456"));
+    CHECK_EQ(display.stats().retries, 80u);
+    // 100 us doubled 10 times exceeds the cap, the other 70 waits are capped
+    uint64_t waits = 100 * ((1u << 10) - 1) + 70 * uint64_t(TM1637_MAX_BACKOFF_US);
+    CHECK(display.stats().recovery_us >= waits);
+    CHECK(display.stats().recovery_us < waits + 100000);
+}
+
+int main()
+{
+    test_give_up();
+    test_resend_after_failure();
+    test_backoff_cap();
+    return check_result();
+}
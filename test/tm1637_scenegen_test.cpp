@@ -0,0 +1,42 @@
+/**
+ * @file tm1637_scenegen_test.cpp
+ * @brief Host test of tools/tm1637_scenegen.cpp against the compile-time page builder.
+ *
+ * The build runs tm1637_scenegen on tm1637_scenegen_test.scene and compiles
+ * the generated header into this test, which requires every page to match
+ * tm1637_page() of the same text and options byte for byte.
+ */
+#include "tm1637_scenegen_test_scene.hpp"
+#include "tm1637_check.hpp"
+
+/**
+ * @brief Compare a generated page with the one tm1637_page() builds.
+ * @param generated Page from the generated header.
+ * @param expected Page built at compile time.
+ */
+static void check_page(const TM1637Page &generated, const TM1637Page &expected)
+{
+    for (size_t i = 0; i < expected.frame.size(); ++i)
+        CHECK_EQ(generated.frame.bytes[i], expected.frame.bytes[i]);
+    CHECK_EQ(generated.duration_ms, expected.duration_ms);
+    CHECK_EQ(generated.attributes, expected.attributes);
+}
+
+/**
+ * @brief Every scene and page of the sample matches the compile-time builder.
+ */
+static void test_pages()
+{
+    static_assert(menu_count == 2, "two pages in scene menu");
+    static_assert(status_count == 2, "two pages in scene status");
+    check_page(menu[0], tm1637_page("SEt  1", 5, 1000));
+    check_page(menu[1], tm1637_page("run.", 7, 500, TM1637_PAGE_BLINK));
+    check_page(status[0], tm1637_page("12.3456", 0));
+    check_page(status[1], tm1637_page("25°C", 7, 65535));
+}
+
+int main()
+{
+    test_pages();
+    return check_result();
+}
@@ -0,0 +1,140 @@
+/**
+ * @file tm1637_scrub_test.cpp
+ * @brief Host test of the background refresh and repairs keeping the display control state.
+ */
+#include "tm1637.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+#include "tm1637_scene.hpp"
+
+#include <algorithm>
+
+/**
+ * @brief Run scrub() over a whole refresh cycle, one step per millisecond.
+ */
+static void scrub_cycle(TM1637 &display)
+{
+    for (size_t i = 0; i < 2 * (TM1637Chip::GRIDS + 1); ++i)
+    {
+        host_set_time_us(time_us_64() + 1000);
+        display.scrub();
+    }
+}
+
+/**
+ * @brief A display switched off by a raw stream stays off through scrub() and repairs.
+ */
+static void test_stays_off()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3, 4);
+    display.write(display.encode_string("123456"));
+    display.set_scrub_budget(1000000);
+
+    const uint8_t off[] = {1, TM1637_CMD3};
+    display.write_raw(off, sizeof(off));
+    CHECK_EQ(chip.ctrl, TM1637_CMD3);
+
+    // corrupt the chip RAM behind the driver's back, the scrub restores it dark
+    chip.ram[2] = 0;
+    scrub_cycle(display);
+    CHECK_EQ(chip.ram[2], display.encode_char('1'));
+    CHECK_EQ(chip.ctrl, TM1637_CMD3);
+
+    // a failed scan marks the shadow dirty, the repair keeps the display off
+    TM1637Keypad keypad;
+    display.attach_keypad(&keypad, 0);
+    chip.nack_every = 1;
+    display.poll_keys();
+    chip.nack_every = 0;
+    display.repair();
+    CHECK_EQ(chip.ctrl, TM1637_CMD3);
+
+    // setting the brightness switches it on again
+    display.brightness(4);
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 4);
+    scrub_cycle(display);
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 4);
+}
+
+/**
+ * @brief The dark phase of a blinking scene page survives the background refresh.
+ */
+static void test_blinking_page()
+{
+    static constexpr TM1637Page pages[] = {tm1637_page("HELLO ", 5, 0, TM1637_PAGE_BLINK)};
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637ScenePlayer player(display);
+    display.set_scrub_budget(1000000);
+    player.play(pages, 1);
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 5);
+
+    host_set_time_us(time_us_64() + 300000);
+    CHECK(player.update());
+    CHECK_EQ(chip.ctrl, TM1637_CMD3);
+    scrub_cycle(display);
+    CHECK_EQ(chip.ctrl, TM1637_CMD3);
+
+    host_set_time_us(time_us_64() + 300000);
+    CHECK(player.update());
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 5);
+    scrub_cycle(display);
+    CHECK_EQ(chip.ctrl, TM1637_CMD3 | TM1637_DSP_ON | 5);
+}
+
+/**
+ * @brief A small budget from an idle loop calling every 100 us adds up to refresh steps.
+ */
+static void test_small_budget()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    display.write(display.encode_string("123456"));
+    display.set_scrub_budget(2000);
+
+    size_t steps = 0;
+    uint64_t bus_us = 0;
+    uint64_t step_us = 0;
+    uint64_t end = time_us_64() + 10000000;
+    while (time_us_64() < end)
+    {
+        host_set_time_us(time_us_64() + 100);
+        uint64_t t0 = time_us_64();
+        if (display.scrub())
+        {
+            ++steps;
+            step_us = std::max(step_us, time_us_64() - t0);
+            bus_us += time_us_64() - t0;
+        }
+    }
+    // 10 s at 2000 us/s, within one step either way
+    CHECK(steps > 0);
+    CHECK(bus_us + step_us >= 20000);
+    CHECK(bus_us <= 20000 + step_us);
+}
+
+/**
+ * @brief The refresh leaves the chip in auto-increment mode for streams without a data command.
+ */
+static void test_keeps_auto_increment()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    display.set_scrub_budget(1000000);
+    scrub_cycle(display);
+
+    const uint8_t digits[] = {7, TM1637_CMD2, 1, 2, 3, 4, 5, 6};
+    display.write_raw(digits, sizeof(digits));
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], addr + 1);
+}
+
+int main()
+{
+    test_stays_off();
+    test_blinking_page();
+    test_small_budget();
+    test_keeps_auto_increment();
+    return check_result();
+}
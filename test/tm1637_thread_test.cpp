@@ -0,0 +1,57 @@
+/**
+ * @file tm1637_thread_test.cpp
+ * @brief Host test of the TM1637_THREAD_SAFE deferred frames and the call timing kept under the bus.
+ */
+#include "tm1637.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+/**
+ * @brief defer() only stores whole wiring groups; flush() sends them.
+ */
+static void test_defer_counts()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    const uint8_t segments[6] = {0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D};
+
+    for (size_t count : {0, 1, 2, 4, 5, 7})
+        CHECK(!display.defer(segments, count));
+    CHECK(!display.flush());
+
+    CHECK(display.defer(segments, 3, 3));
+    CHECK(display.flush());
+    CHECK_EQ(chip.ram[3], 0x4F);
+    CHECK_EQ(chip.ram[4], 0x5B);
+    CHECK_EQ(chip.ram[5], 0x06);
+
+    CHECK(display.defer(segments, 6));
+    CHECK(display.flush());
+    for (size_t addr = 0; addr < 6; ++addr)
+        CHECK_EQ(chip.ram[addr], segments[TM1637Chip::digit_at(addr)]);
+}
+
+/**
+ * @brief Blocking calls record their duration.
+ */
+static void test_call_timing()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    display.reset_stats();
+    uint64_t t0 = time_us_64();
+    display.write(display.encode_string("123456"));
+    uint64_t elapsed = time_us_64() - t0;
+    CHECK(display.stats().max_call_us > 0);
+    CHECK(display.stats().max_call_us <= elapsed);
+    // the bus was released again, or flush() would spin
+    CHECK(display.defer(display.encode_string("654321").data(), 6));
+    CHECK(display.flush());
+}
+
+int main()
+{
+    test_defer_counts();
+    test_call_timing();
+    return check_result();
+}
@@ -0,0 +1,156 @@
+/**
+ * @file tm1637_timer_test.cpp
+ * @brief Host test of the countdown and stopwatch widgets on simulated alarms and a virtual chip.
+ */
+#include "tm1637_timer.hpp"
+#include "tm1637_check.hpp"
+#include "tm1637_model.hpp"
+
+/**
+ * @brief Move the clock to an offset from t0, fire the due alarms and send the digits.
+ */
+static void advance(TM1637Timer &timer, uint64_t t0, uint64_t offset_us)
+{
+    host_set_time_us(t0 + offset_us);
+    host_alarm_step();
+    timer.update();
+}
+
+/**
+ * @brief Check that the chip shows a text.
+ */
+static bool shows(const TM1637Model &chip, TM1637 &display, const char *text)
+{
+    Segments want = display.encode_string(text);
+    for (size_t addr = 0; addr < 6; ++addr)
+        if (chip.ram[addr] != want[TM1637Chip::digit_at(addr)])
+            return false;
+    return true;
+}
+
+/**
+ * @brief Count expiry callbacks.
+ */
+static void count_done(TM1637Timer &, void *user)
+{
+    ++*static_cast<int *>(user);
+}
+
+/**
+ * @brief A countdown rounds the shown time up and expires once, exactly at the deadline.
+ */
+static void test_countdown()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637Timer timer(display);
+    int done = 0;
+    uint64_t t0 = time_us_64();
+    CHECK(timer.start_countdown(2500, count_done, &done));
+    timer.update();
+    CHECK(shows(chip, display, "  00.03"));
+
+    // the shown second changes on the half seconds of a 2.5 s countdown
+    advance(timer, t0, 499000);
+    CHECK(shows(chip, display, "  00.03"));
+    advance(timer, t0, 501000);
+    CHECK(shows(chip, display, "  00.02"));
+    CHECK(timer.time_ms() >= 1998 && timer.time_ms() <= 1999);
+    advance(timer, t0, 1600000);
+    CHECK(shows(chip, display, "  00.01"));
+    CHECK(timer.running());
+    CHECK(!timer.expired());
+
+    advance(timer, t0, 2600000);
+    CHECK(shows(chip, display, "  00.00"));
+    CHECK(!timer.running());
+    CHECK(timer.expired());
+    CHECK_EQ(done, 1);
+    CHECK_EQ(timer.time_ms(), 0u);
+
+    advance(timer, t0, 10000000);
+    CHECK_EQ(done, 1);
+    CHECK(timer.resume());
+    CHECK(!timer.running());
+}
+
+/**
+ * @brief A zero-length countdown expires at once instead of counting up.
+ */
+static void test_zero_countdown()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637Timer timer(display);
+    int done = 0;
+    uint64_t t0 = time_us_64();
+    CHECK(timer.start_countdown(0, count_done, &done));
+    CHECK_EQ(done, 1);
+    CHECK(timer.expired());
+    CHECK(!timer.running());
+    timer.update();
+    CHECK(shows(chip, display, "  00.00"));
+
+    advance(timer, t0, 5000000);
+    CHECK_EQ(timer.time_ms(), 0u);
+    CHECK_EQ(done, 1);
+    CHECK(shows(chip, display, "  00.00"));
+}
+
+/**
+ * @brief stop() freezes the time, resume() continues from there.
+ */
+static void test_stop_resume()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637Timer timer(display);
+    int done = 0;
+    uint64_t t0 = time_us_64();
+    CHECK(timer.start_countdown(5000, count_done, &done));
+    advance(timer, t0, 1200000);
+    timer.stop();
+    timer.update();
+    uint32_t left = timer.time_ms();
+    CHECK(left >= 3790 && left <= 3800);
+    CHECK(shows(chip, display, "  00.04"));
+
+    advance(timer, t0, 20000000);
+    CHECK_EQ(timer.time_ms(), left);
+    CHECK(!timer.expired());
+    CHECK(shows(chip, display, "  00.04"));
+
+    CHECK(timer.resume());
+    advance(timer, t0, 20000000 + 1000000);
+    CHECK(shows(chip, display, "  00.03"));
+    advance(timer, t0, 20000000 + 3900000);
+    CHECK(timer.expired());
+    CHECK_EQ(done, 1);
+}
+
+/**
+ * @brief A stopwatch counts up in hundredths and keeps running.
+ */
+static void test_stopwatch()
+{
+    TM1637Model chip(2, 3);
+    TM1637 display(2, 3);
+    TM1637Timer timer(display, TM1637_TIMER_SSHH);
+    uint64_t t0 = time_us_64();
+    CHECK(timer.start_stopwatch());
+    advance(timer, t0, 12345000);
+    CHECK(shows(chip, display, "  12.34"));
+    CHECK(timer.time_ms() >= 12345);
+    CHECK(timer.running());
+    CHECK(!timer.expired());
+    timer.stop();
+}
+
+int main()
+{
+    test_countdown();
+    test_zero_countdown();
+    test_stop_resume();
+    test_stopwatch();
+    return check_result();
+}
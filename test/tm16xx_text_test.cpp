@@ -0,0 +1,98 @@
+/**
+ * @file tm16xx_text_test.cpp
+ * @brief Host test of the text encoder in tm16xx.hpp.
+ */
+#include "tm16xx.hpp"
+#include "tm1637_check.hpp"
+
+#include <cstring>
+
+/**
+ * @brief Encode text for a TM1637 module, digits in display order.
+ */
+static void encode(const char *str, uint8_t (&out)[TM1637Chip::GRIDS])
+{
+    tm16xx_encode_text<TM1637Chip>(str, std::strlen(str), out);
+}
+
+/**
+ * @brief A '.' lights the digit before it, unless that digit was dropped for lack of room.
+ */
+static void test_decimal_point()
+{
+    uint8_t out[TM1637Chip::GRIDS];
+    encode("12.3", out);
+    CHECK_EQ(out[1], TM16XX_FONT['2'] | TM16XX_DP);
+    CHECK_EQ(out[2], TM16XX_FONT['3']);
+
+    // the sixth digit is the last shown, its point still fits
+    encode("123456.", out);
+    CHECK_EQ(out[5], TM16XX_FONT['6'] | TM16XX_DP);
+
+    // '7' is dropped, so is its point; "123456." would misplace it
+    encode("1234567.8", out);
+    const char *digits = "123456";
+    for (size_t i = 0; i < TM1637Chip::GRIDS; ++i)
+        CHECK_EQ(out[i], TM16XX_FONT[digits[i]]);
+}
+
+/**
+ * @brief Overrides accept ASCII only; a byte above 0x7F leaves the ASCII glyphs alone.
+ */
+static void test_font_override()
+{
+    constexpr TM16xxFont font = TM16XX_FONT.with('k', 0x75).with(0, 0x49);
+    CHECK_EQ(font['k'], 0x75);
+    CHECK_EQ(font['K'], TM16XX_FONT['K']);
+    CHECK_EQ(font['\xB0'], 0x49);
+
+    // '\xB0' & 0x7F is '0'; at run time with() ignores it, in a constant expression it does not compile
+    volatile char degree = '\xB0';
+    TM16xxFont copy = TM16XX_FONT.with(degree, 0x63);
+    CHECK_EQ(copy['0'], 0x3F);
+    CHECK(!copy.set(degree, 0x63));
+    CHECK_EQ(copy['0'], 0x3F);
+    CHECK(copy.set('x', 0x49));
+    CHECK_EQ(copy['x'], 0x49);
+}
+
+/**
+ * @brief A font's code point glyphs take precedence over TM16XX_GLYPHS, at compile and run time.
+ */
+static void test_code_point_override()
+{
+    constexpr TM16xxFont font = TM16XX_FONT.with_code_point(U'\u00B0', 0x21).with_code_point(U'\u03A9', 0x37);
+    static_assert(font.find(0x00B0) == 0x21, "override of a TM16XX_GLYPHS entry");
+    static_assert(font.find(0x03A9) == 0x37, "new code point");
+    static_assert(font.find(0x00B5) == 0x1C, "the rest still comes from TM16XX_GLYPHS");
+    static_assert(font['0'] == 0x3F, "ASCII untouched");
+
+    uint8_t out[TM1637Chip::GRIDS];
+    const char *text = "25\u00B0\u03A9";
+    tm16xx_encode_text<TM1637Chip>(text, std::strlen(text), out, font);
+    CHECK_EQ(out[2], 0x21);
+    CHECK_EQ(out[3], 0x37);
+    encode(text, out);
+    CHECK_EQ(out[2], 0x63);
+    CHECK_EQ(out[3], TM16XX_FONT.glyphs[0]);
+
+    // run time: replace, fill up to CODE_POINTS, then refuse
+    TM16xxFont copy = TM16XX_FONT;
+    CHECK(copy.set_code_point(0x00B0, 0x01));
+    CHECK(copy.set_code_point(0x00B0, 0x02));
+    CHECK_EQ(copy.find(0x00B0), 0x02);
+    for (char32_t code = 0x0391; copy.code_point_count < TM16xxFont::CODE_POINTS; ++code)
+        CHECK(copy.set_code_point(code, 0x40));
+    CHECK(!copy.set_code_point(0x2126, 0x37));
+    CHECK_EQ(copy.find(0x2126), -1);
+    CHECK(copy.set_code_point(U'k', 0x75));
+    CHECK_EQ(copy['k'], 0x75);
+}
+
+int main()
+{
+    test_decimal_point();
+    test_font_override();
+    test_code_point_override();
+    return check_result();
+}
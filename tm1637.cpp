@@ -1,336 +1,1578 @@
-/**
- * @file tm1637.cpp
- * @brief Implementation of the TM1637 class for controlling a 4-digit 7-segment display.
- */
-#include "tm1637.hpp"
-
-#include <pico/stdlib.h>
-#include <iostream>
-#include <sstream>
-#include <iomanip>
-#include <utility>
-
-/**
- * @brief TM1637 command for sending data to the display.
- */
-const uint8_t TM1637_CMD1 = 0x40;
-
-/**
- * @brief TM1637 command for addressing a specific digit on the display.
- */
-const uint8_t TM1637_CMD2 = 0xC0;
-
-/**
- * @brief TM1637 command for controlling the display.
- */
-const uint8_t TM1637_CMD3 = 0x80;
-
-/**
- * @brief TM1637 display control command for turning on the display.
- */
-const uint8_t TM1637_DSP_ON = 0x08;
-
-/**
- * @brief Time delay in microseconds between clock (clk) and data (dio) pulses.
- */
-const uint8_t TM1637_DELAY = 10;
-
-/**
- * @brief Most significant bit (MSB) indicating the decimal point or colon on the display.
- */
-const uint8_t TM1637_MSB = 0x80;
-
-/**
- * @brief Array of 7-segment LED segments for digits 0-9, a-z, space, dash, and star.
- */
-// 0 - 9, a - z, blank, dash, star
-uint8_t _SEGMENTS[] = {
-    0x3F, // 	0	0
-    0x06, // 	1	1
-    0x5B, // 	2	2
-    0x4F, // 	3	3
-    0x66, // 	4	4
-    0x6D, // 	5	5
-    0x7D, // 	6	6
-    0x07, // 	7	7
-    0x7F, // 	8	8
-    0x6F, // 	9	9
-    0x77, // 	10	a
-    0x7C, // 	11	b
-    0x39, // 	12	c
-    0x5E, // 	13	d
-    0x79, // 	14	e
-    0x71, // 	15	f
-    0x3D, // 	16	g
-    0x76, // 	17	h
-    0x06, // 	18	i
-    0x1E, // 	19	j
-    0x76, // 	20	k
-    0x38, // 	21	l
-    0x55, // 	22	m
-    0x54, // 	23	n
-    0x5C, // 0x3F, // 	24	o
-    0x73, // 	25	p
-    0x67, // 	26	q
-    0x50, // 	27	r
-    0x6D, // 	28	s
-    0x78, // 	29	t
-    0x3E, // 	30	u
-    0x1C, // 	31	v
-    0x2A, // 	32	w
-    0x76, // 	33	x
-    0x6E, // 	34	y
-    0x5B, // 	35	z
-    0x00, // 	36	space
-    0x40, // 	37	-
-    0x63  //	38	*
-};
-
-/**
- * @brief Constructor for the TM1637 class.
- * @param clk Pin number for the clock (CLK) line.
- * @param dio Pin number for the data (DIO) line.
- * @param brightness Brightness level for the display (0-7).
- */
-TM1637::TM1637(uint8_t clk, uint8_t dio, uint8_t brightness)
-    : clk_(clk), dio_(dio), brightness_(std::min(uint8_t(0x07), brightness))
-{
-    gpio_init(clk_);
-    gpio_set_dir(clk_, GPIO_OUT);
-    gpio_pull_up(clk_);
-    gpio_init(dio_);
-    gpio_set_dir(dio_, GPIO_OUT);
-    gpio_pull_up(dio_);
-    gpio_put(clk_, 0);
-    gpio_put(dio_, 0);
-
-    _write_data_cmd();
-    _write_dsp_ctrl();
-}
-
-/**
- * @brief Private method to start communication with the TM1637.
- */
-void TM1637::_start()
-{
-    // std::cout << __FUNCTION__ << std::endl;
-    gpio_put(clk_, 1);
-    sleep_us(TM1637_DELAY);
-    gpio_put(dio_, 1);
-    sleep_us(TM1637_DELAY);
-    gpio_put(dio_, 0);
-    sleep_us(TM1637_DELAY);
-    gpio_put(clk_, 0);
-    sleep_us(TM1637_DELAY);
-}
-
-/**
- * @brief Private method to stop communication with the TM1637.
- */
-void TM1637::_stop()
-{
-    // std::cout << __FUNCTION__ << std::endl;
-    gpio_put(clk_, 0);
-    sleep_us(TM1637_DELAY);
-    gpio_put(dio_, 0);
-    sleep_us(TM1637_DELAY);
-    gpio_put(clk_, 1);
-    sleep_us(TM1637_DELAY);
-    gpio_put(dio_, 1);
-}
-
-/**
- * @brief Private method to send the data command to the TM1637.
- */
-void TM1637::_write_data_cmd()
-{
-    // std::cout << __FUNCTION__ << std::endl;
-    // automatic address increment, normal mode
-    _start();
-    _write_byte(TM1637_CMD1);
-    _stop();
-}
-
-/**
- * @brief Private method to send the display control command to the TM1637.
- */
-void TM1637::_write_dsp_ctrl()
-{
-    // std::cout << __FUNCTION__ << " " << (TM1637_CMD3 | TM1637_DSP_ON | brightness_) << std::endl;
-    // display on, set brightness
-    _start();
-    _write_byte(TM1637_CMD3 | TM1637_DSP_ON | brightness_);
-    _stop();
-}
-
-/**
- * @brief Private method to write a byte to the TM1637.
- * @param b The byte to be written.
- */
-void TM1637::_write_byte(uint8_t b)
-{
-    // std::cout << __FUNCTION__ << " " << (uint)b << std::endl;
-    for (int i = 0; i < 8; ++i)
-    {
-        gpio_put(dio_, (b >> i) & 1);
-        sleep_us(TM1637_DELAY);
-        gpio_put(clk_, 1);
-        sleep_us(TM1637_DELAY);
-        gpio_put(clk_, 0);
-        sleep_us(TM1637_DELAY);
-    }
-    gpio_put(clk_, 0);
-    sleep_us(TM1637_DELAY);
-    gpio_put(clk_, 1);
-    sleep_us(TM1637_DELAY);
-    gpio_put(clk_, 0);
-    sleep_us(TM1637_DELAY);
-}
-
-/**
- * @brief Set the brightness level of the display.
- * @param val Brightness level (0-7).
- * @return The updated brightness level.
- */
-uint8_t TM1637::brightness(uint8_t val)
-{
-    // Set the display brightness 0-7."
-    // brightness 0 = 1 / 16th pulse width
-    // brightness 7 = 14 / 16th pulse width
-    brightness_ = (val & 0x07);
-    _write_data_cmd();
-    _write_dsp_ctrl();
-    return brightness_;
-}
-
-/**
- * @brief Write segments to the display starting from a specific position.
- * @param segments Array of 7-segment LED segments.
- * @param pos Starting position on the display (0-5).
- */
-void TM1637::write(Segments segments, uint8_t pos)
-{
-    // Display up to 6 segments moving right from a given position.
-    // The MSB in the 2nd segment controls the colon between the 2nd
-    // and 3rd segments.
-    pos = std::min(pos, uint8_t(0x05));
-    _write_data_cmd();
-    _start();
-
-    _write_byte(TM1637_CMD2 | pos);
-
-    // for seg in segments:
-    // _write_byte(seg)
-    for (size_t i = 0; i < segments.size(); ++i)
-        _write_byte(segments.at(uint8_t(i / 3) * 6 + 2 - i));
-
-    _stop();
-    _write_dsp_ctrl();
-}
-
-/**
- * @brief Encode a decimal digit into a 7-segment LED segment.
- * @param digit The decimal digit to be encoded (0-9).
- * @return The encoded 7-segment LED segment.
- */
-uint8_t TM1637::encode_digit(uint8_t digit)
-{
-    // Convert a character 0-9, a-f to a segment.
-    return _SEGMENTS[digit & 0x0f];
-}
-
-/**
- * @brief Encode a decimal digit into a 7-segment LED segment.
- * @param digit The decimal digit to be encoded (0-9).
- * @return The encoded 7-segment LED segment.
- */
-Segments TM1637::encode_string(std::string str)
-{
-    // Convert a string to LED segments.
-    // Convert an up to 4 character length string containing 0-9, a-z,
-    // space, dash, star and '.' to an array of segments, matching the length of
-    // the source string.
-    size_t d = 0;
-    for (size_t i = 0; i < str.size(); ++i)
-        if (str.at(i) != '.')
-            ++d;
-    Segments segments;
-    segments.resize(d);
-
-    size_t j = 0;
-    for (size_t i = 0; i < str.size(); ++i)
-    {
-        if ((str.at(i) == '.') && (j > 0))
-        {
-            segments.at(j - 1) |= TM1637_MSB;
-        }
-        else
-        {
-            segments[j] = encode_char(str.at(i));
-            j += 1;
-        }
-    }
-    while (segments.size() < 6)
-        segments.push_back(encode_char(' '));
-    return segments;
-}
-
-/**
- * @brief Encode a character into a 7-segment LED segment.
- * @param ch The input character.
- * @return The encoded 7-segment LED segment.
- */
-uint8_t TM1637::encode_char(char ch)
-{
-    // Convert a character 0-9, a-z, space, dash or star to a segment."
-    // o = ord(ch);
-    if (ch == 32)
-        return _SEGMENTS[36]; //  space
-    if (ch == 42)
-        return _SEGMENTS[38]; //  star/degrees
-    if (ch == 45)
-        return _SEGMENTS[37]; //  dash
-    if ((ch >= 65) && (ch <= 90))
-        return _SEGMENTS[ch - 55]; //  uppercase A-Z
-    if ((ch >= 97) && (ch <= 122))
-        return _SEGMENTS[ch - 87]; //  lowercase a-z
-    if ((ch >= 48) && (ch <= 57))
-        return _SEGMENTS[ch - 48]; //  0-9
-    return _SEGMENTS[38];          //  star/degrees
-}
-
-/**
- * @brief Display a hexadecimal value on the TM1637 display.
- * @param val The hexadecimal value (0x0000 - 0xffff).
- */
-void TM1637::hex(uint16_t val)
-{
-    // Display a hex value 0x0000 through 0xffff, right aligned."
-    std::stringstream ss;
-    ss << std::hex << std::setw(6) << val;
-    write(encode_string(ss.str()));
-}
-
-/**
- * @brief Display a numeric value on the TM1637 display.
- * @param num The numeric value (-999 to 9999).
- */
-void TM1637::number(uint32_t num)
-{
-    // Display a numeric value -999 through 9999, right aligned."
-    // limit to range - 999 to 9999
-    std::stringstream ss;
-    ss << std::dec << std::setw(6) << num;
-    write(encode_string(ss.str()));
-}
-
-/**
- * @brief Display a string on the TM1637 display.
- * @param str The input string.
- * @param colon Whether to display the colon symbol.
- */
-void TM1637::show(std::string str, bool colon)
-{
-    Segments segments = encode_string(str);
-    write(segments);
-}
\ No newline at end of file
+/**
+ * @file tm1637.cpp
+ * @brief Implementation of the TM1637 class for controlling a 4-digit 7-segment display.
+ */
+#include "tm1637.hpp"
+
+#include <pico/stdlib.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef TM1637_USE_PIO
+#include <hardware/clocks.h>
+#include "tm1637.pio.h"
+#endif
+
+#ifdef TM1637_USE_DMA
+#include <hardware/dma.h>
+#include <hardware/irq.h>
+#include <hardware/sync.h>
+
+/**
+ * @brief Display owning each DMA channel, used to dispatch the shared DMA_IRQ_0.
+ */
+static TM1637 *_dma_owners[NUM_DMA_CHANNELS];
+#endif
+
+#ifdef TM1637_RUN_FROM_RAM
+#define TM1637_RAM_FUNC(name) __not_in_flash_func(name)
+#else
+#define TM1637_RAM_FUNC(name) name
+#endif
+
+#ifdef TM1637_THREAD_SAFE
+#define TM1637_BUS_ACQUIRE() _bus_acquire(true)
+#define TM1637_BUS_RELEASE() _bus_release()
+#else
+#define TM1637_BUS_ACQUIRE() ((void)0)
+#define TM1637_BUS_RELEASE() ((void)0)
+#endif
+
+// Line levels of the bit-banged bus. In open-drain mode the output latches
+// stay low: a line is pulled low by making it an output and released to the
+// pull-up by making it an input, so nothing ever drives against the chip.
+#ifdef TM1637_OPEN_DRAIN
+#define TM1637_HIGH(mask) gpio_set_dir_in_masked(mask)
+#define TM1637_LOW(mask) gpio_set_dir_out_masked(mask)
+#define TM1637_PUT(mask, bit) gpio_set_dir_masked(mask, (mask) & ((bit) - 1u))
+#define TM1637_DRIVE(mask) ((void)0)
+#else
+#define TM1637_HIGH(mask) gpio_set_mask(mask)
+#define TM1637_LOW(mask) gpio_clr_mask(mask)
+#define TM1637_PUT(mask, bit) gpio_put_masked(mask, 0u - (bit))
+#define TM1637_DRIVE(mask) gpio_set_dir_out_masked(mask)
+#endif
+
+#ifdef TM1637_STATS
+namespace
+{
+    /**
+     * @brief Stopwatch recording the duration of a blocking call into TM1637Stats::max_call_us.
+     *
+     * stop() is called while the bus is still held: with TM1637_THREAD_SAFE
+     * the other core may take the bus as soon as it is released, and the
+     * statistics are only guarded by the bus.
+     */
+    class CallTimer
+    {
+    public:
+        explicit CallTimer(TM1637Stats &stats) : stats_(stats), start_(time_us_64()) {}
+        void stop()
+        {
+            uint32_t elapsed = uint32_t(time_us_64() - start_);
+            if (elapsed > stats_.max_call_us)
+                stats_.max_call_us = elapsed;
+        }
+
+    private:
+        TM1637Stats &stats_;
+        uint64_t start_;
+    };
+}
+#define TM1637_STAT(expr) (expr)
+#define TM1637_TIME_CALL() CallTimer call_timer(stats_)
+#define TM1637_TIME_END() call_timer.stop()
+#else
+#define TM1637_STAT(expr) ((void)0)
+#define TM1637_TIME_CALL() ((void)0)
+#define TM1637_TIME_END() ((void)0)
+#endif
+
+/**
+ * @brief Time delay in microseconds between clock (clk) and data (dio) pulses.
+ *
+ * Open-drain rising edges depend on the pull-ups charging the cable, so that
+ * mode starts from a longer half period; calibrate() can shorten either.
+ */
+#ifdef TM1637_OPEN_DRAIN
+const uint8_t TM1637_DELAY = 25;
+#else
+const uint8_t TM1637_DELAY = 10;
+#endif
+
+/**
+ * @brief Format an unsigned value right aligned in a field padded with spaces.
+ * @param val The value to format.
+ * @param base Number base (10 or 16, lowercase hex digits).
+ * @param width Minimum field width.
+ * @return The formatted string.
+ */
+static std::string _format_right(uint32_t val, uint8_t base, size_t width)
+{
+    char buf[16];
+    size_t n = sizeof(buf);
+    do
+    {
+        uint8_t d = val % base;
+        buf[--n] = char(d < 10 ? '0' + d : 'a' + d - 10);
+        val /= base;
+    } while (val);
+    while ((sizeof(buf) - n < width) && (n > 0))
+        buf[--n] = ' ';
+    return std::string(buf + n, sizeof(buf) - n);
+}
+
+/**
+ * @brief Round a decimal digit string to a number of significant digits, half up.
+ * @param digits Decimal digits, most significant first, without leading zeros.
+ * @param n Number of digits.
+ * @param k Significant digits to keep, padded with zeros if n is shorter.
+ * @param out Receives k digits.
+ * @return true if rounding carried into a new leading digit (out is then "10...0").
+ */
+static bool _round_digits(const char *digits, size_t n, size_t k, char *out)
+{
+    for (size_t i = 0; i < k; ++i)
+        out[i] = (i < n) ? digits[i] : '0';
+    if ((k >= n) || (digits[k] < '5'))
+        return false;
+    for (size_t i = k; i-- > 0;)
+    {
+        if (out[i] != '9')
+        {
+            ++out[i];
+            return false;
+        }
+        out[i] = '0';
+    }
+    out[0] = '1';
+    return true;
+}
+
+/**
+ * @brief Lay out significant digits as a decimal number without trailing fraction zeros.
+ * @param sig Significant digits, most significant first.
+ * @param k Number of significant digits.
+ * @param int_digits Digits before the decimal point; 0 or less gives "0.", then leading zeros.
+ * @return The number.
+ */
+static std::string _place_digits(const char *sig, size_t k, int int_digits)
+{
+    std::string s;
+    if (int_digits <= 0)
+    {
+        s = "0.";
+        s.append(size_t(-int_digits), '0');
+        s.append(sig, k);
+    }
+    else
+    {
+        for (size_t i = 0; i < size_t(int_digits); ++i)
+            s += (i < k) ? sig[i] : '0';
+        if (size_t(int_digits) < k)
+        {
+            s += '.';
+            s.append(sig + int_digits, k - int_digits);
+        }
+    }
+    if (s.find('.') != std::string::npos)
+    {
+        while (s.back() == '0')
+            s.pop_back();
+        if (s.back() == '.')
+            s.pop_back();
+    }
+    return s;
+}
+
+/**
+ * @brief Constructor for the TM1637 class.
+ * @param clk Pin number for the clock (CLK) line.
+ * @param dio Pin number for the data (DIO) line.
+ * @param brightness Brightness level for the display (0-7).
+ */
+TM1637::TM1637(uint8_t clk, uint8_t dio, uint8_t brightness)
+    : clk_(clk), dio_(dio), brightness_(std::min(uint8_t(0x07), brightness)),
+      font_(&TM16XX_FONT), fallback_(TM16XX_FALLBACK_GLYPH),
+      clk_mask_(1ul << clk), dio_mask_(1ul << dio),
+      keypad_(nullptr), key_interval_us_(0), key_last_us_(0),
+      delay_us_(TM1637_DELAY), nack_seen_(false),
+      ram_(), ctrl_(0), ram_dirty_(false), max_retries_(2), backoff_us_(100),
+      scrub_budget_us_(0), scrub_tokens_(0), scrub_last_us_(0), scrub_next_(0)
+#ifdef TM1637_USE_PIO
+      ,
+      pio_(nullptr), sm_(0), pio_word_(0), pio_start_(false),
+      pio_capture_(nullptr), pio_captured_(0)
+#endif
+#ifdef TM1637_USE_DMA
+      ,
+      dma_chan_(-1), dma_len_(), dma_done_(), dma_user_(), dma_free_(nullptr), dma_free_user_(nullptr),
+      dma_cur_(0), dma_sending_(false), dma_queued_(false)
+#endif
+{
+#ifdef TM1637_STATS
+    reset_stats();
+#endif
+#ifdef TM1637_THREAD_SAFE
+    _init_lock();
+#endif
+
+    gpio_init(clk_);
+    gpio_pull_up(clk_);
+    gpio_init(dio_);
+    gpio_pull_up(dio_);
+    gpio_put(clk_, 0);
+    gpio_put(dio_, 0);
+#ifdef TM1637_OPEN_DRAIN
+    // both lines released: the bus idles high on the pull-ups
+    gpio_set_dir(clk_, GPIO_IN);
+    gpio_set_dir(dio_, GPIO_IN);
+#else
+    gpio_set_dir(clk_, GPIO_OUT);
+    gpio_set_dir(dio_, GPIO_OUT);
+#endif
+
+    // the chip RAM is undefined after power-up, clear it to match the shadow
+    _write_frame(Segments(TM1637Chip::GRIDS, 0), 0);
+}
+
+#ifdef TM1637_USE_PIO
+/**
+ * @brief Constructor for a TM1637 driven by a PIO state machine instead of bit-banging.
+ * @param clk Pin number for the clock (CLK) line.
+ * @param dio Pin number for the data (DIO) line.
+ * @param pio PIO instance running the tm1637 program.
+ * @param sm State machine index to claim on that PIO.
+ * @param brightness Brightness level for the display (0-7).
+ */
+TM1637::TM1637(uint8_t clk, uint8_t dio, PIO pio, uint sm, uint8_t brightness)
+    : clk_(clk), dio_(dio), brightness_(std::min(uint8_t(0x07), brightness)),
+      font_(&TM16XX_FONT), fallback_(TM16XX_FALLBACK_GLYPH),
+      clk_mask_(1ul << clk), dio_mask_(1ul << dio),
+      keypad_(nullptr), key_interval_us_(0), key_last_us_(0),
+      delay_us_(TM1637_DELAY), nack_seen_(false),
+      ram_(), ctrl_(0), ram_dirty_(false), max_retries_(2), backoff_us_(100),
+      scrub_budget_us_(0), scrub_tokens_(0), scrub_last_us_(0), scrub_next_(0),
+      pio_(pio), sm_(sm), pio_word_(0), pio_start_(false),
+      pio_capture_(nullptr), pio_captured_(0)
+#ifdef TM1637_USE_DMA
+      ,
+      dma_chan_(-1), dma_len_(), dma_done_(), dma_user_(), dma_free_(nullptr), dma_free_user_(nullptr),
+      dma_cur_(0), dma_sending_(false), dma_queued_(false)
+#endif
+{
+#ifdef TM1637_STATS
+    reset_stats();
+#endif
+#ifdef TM1637_THREAD_SAFE
+    _init_lock();
+#endif
+
+    // load the program once per PIO block, displays on the same PIO share it
+    static int offsets[NUM_PIOS] = {};
+    static bool loaded[NUM_PIOS] = {};
+    uint idx = pio_get_index(pio_);
+    if (!loaded[idx])
+    {
+        offsets[idx] = pio_add_program(pio_, &tm1637_program);
+        loaded[idx] = true;
+    }
+    pio_sm_claim(pio_, sm_);
+    tm1637_program_init(pio_, sm_, offsets[idx], clk_, dio_, delay_us_);
+
+    // the chip RAM is undefined after power-up, clear it to match the shadow
+    _write_frame(Segments(TM1637Chip::GRIDS, 0), 0);
+}
+#endif
+
+/**
+ * @brief Private method to start communication with the TM1637.
+ */
+void TM1637_RAM_FUNC(TM1637::_start)()
+{
+    TM1637_STAT(++stats_.transactions);
+#ifdef TM1637_USE_PIO
+    if (pio_)
+    {
+#ifdef TM1637_USE_DMA
+        // blocking traffic must not interleave with a frame still in the FIFO path
+        if (!pio_capture_)
+            while (busy())
+                tight_loop_contents();
+#endif
+        pio_start_ = true;
+        return;
+    }
+#endif
+    TM1637_HIGH(clk_mask_);
+    _delay();
+    TM1637_HIGH(dio_mask_);
+    _delay();
+    TM1637_LOW(dio_mask_);
+    _delay();
+    TM1637_LOW(clk_mask_);
+    _delay();
+}
+
+/**
+ * @brief Private method to stop communication with the TM1637.
+ */
+void TM1637_RAM_FUNC(TM1637::_stop)()
+{
+#ifdef TM1637_USE_PIO
+    if (pio_)
+    {
+        // the stop condition is appended to the last byte of the transaction
+        _pio_put(pio_word_ | (1u << 9));
+        pio_word_ = 0;
+        return;
+    }
+#endif
+    TM1637_LOW(clk_mask_);
+    _delay();
+    TM1637_LOW(dio_mask_);
+    _delay();
+    TM1637_HIGH(clk_mask_);
+    _delay();
+    TM1637_HIGH(dio_mask_);
+}
+
+/**
+ * @brief Private method to send the data command to the TM1637.
+ */
+void TM1637::_write_data_cmd()
+{
+    // automatic address increment, normal mode
+    _start();
+    _write_byte(TM1637_CMD1);
+    _stop();
+}
+
+/**
+ * @brief Private method to send the display control command to the TM1637.
+ */
+void TM1637::_write_dsp_ctrl()
+{
+    // display on, set brightness
+    ctrl_ = TM1637_CMD3 | TM1637_DSP_ON | brightness_;
+    _write_ctrl();
+}
+
+/**
+ * @brief Private method to re-send the last display control byte, which may have switched the display off.
+ */
+void TM1637::_write_ctrl()
+{
+    _start();
+    _write_byte(ctrl_);
+    _stop();
+}
+
+/**
+ * @brief Private method to write a byte to the TM1637.
+ * @param b The byte to be written.
+ * @return true if the chip acknowledged the byte (always true on a PIO driven display).
+ */
+bool TM1637_RAM_FUNC(TM1637::_write_byte)(uint8_t b)
+{
+    TM1637_STAT(++stats_.bytes);
+    TM1637_STAT(stats_.bit_times += 9); // 8 data bits plus the ACK slot
+#ifdef TM1637_USE_PIO
+    if (pio_)
+    {
+        // hold the byte back, the next call tells whether a stop follows it;
+        // bit 10 only marks the word as pending, the program never shifts it out
+        if (pio_word_)
+            _pio_put(pio_word_);
+        pio_word_ = (uint32_t(b) << 1) | (pio_start_ ? 1u : 0u) | (1u << 10);
+        pio_start_ = false;
+        return true;
+    }
+#endif
+    // LSB first; the data bit goes out through the SIO toggle (push-pull)
+    // or direction (open-drain) register without branching, the loop is
+    // fully unrolled.
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i)
+    {
+        TM1637_PUT(dio_mask_, (b >> i) & 1u);
+        _delay();
+        TM1637_HIGH(clk_mask_);
+        _delay();
+        TM1637_LOW(clk_mask_);
+        _delay();
+    }
+    // ACK slot: release DIO so the chip can pull it low
+    TM1637_LOW(clk_mask_);
+    gpio_set_dir_in_masked(dio_mask_);
+    _delay();
+    TM1637_HIGH(clk_mask_);
+    _delay();
+    bool ack = !gpio_get(dio_);
+    TM1637_LOW(clk_mask_);
+    TM1637_DRIVE(dio_mask_);
+    _delay();
+    if (!ack)
+        nack_seen_ = true;
+    return ack;
+}
+
+#ifdef TM1637_USE_PIO
+/**
+ * @brief Private method to hand one word to the state machine, or to the frame being captured.
+ * @param word FIFO word as consumed by tm1637.pio.
+ */
+void TM1637::_pio_put(uint32_t word)
+{
+    if (pio_capture_)
+        pio_capture_[pio_captured_++] = word;
+    else
+        pio_sm_put_blocking(pio_, sm_, word);
+}
+#endif
+
+/**
+ * @brief Private method to read a byte from the TM1637, DIO released to the chip.
+ * @return The byte read, LSB first.
+ */
+uint8_t TM1637_RAM_FUNC(TM1637::_read_byte)()
+{
+    TM1637_STAT(++stats_.bytes);
+    TM1637_STAT(stats_.bit_times += 9);
+    // the chip shifts a bit out on the falling CLK edge, sample it while CLK is high
+    gpio_set_dir_in_masked(dio_mask_);
+    uint8_t b = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        TM1637_LOW(clk_mask_);
+        _delay();
+        TM1637_HIGH(clk_mask_);
+        _delay();
+        if (gpio_get(dio_))
+            b |= uint8_t(1u << i);
+    }
+    // acknowledge by driving DIO low for the ninth clock
+    TM1637_LOW(clk_mask_);
+    TM1637_LOW(dio_mask_);
+    TM1637_DRIVE(dio_mask_);
+    _delay();
+    TM1637_HIGH(clk_mask_);
+    _delay();
+    TM1637_LOW(clk_mask_);
+    _delay();
+    return b;
+}
+
+/**
+ * @brief Private method to wait one bus half period (bus_delay()).
+ */
+void TM1637_RAM_FUNC(TM1637::_delay)()
+{
+    TM1637_STAT(stats_.sleep_us += delay_us_);
+#ifdef TM1637_RUN_FROM_RAM
+    // sleep_us() lives in flash, spin on the timer instead
+    uint32_t start = time_us_32();
+    while (time_us_32() - start < delay_us_)
+        tight_loop_contents();
+#else
+    sleep_us(delay_us_);
+#endif
+}
+
+/**
+ * @brief Get the bus half period in use.
+ * @return The delay between clock and data edges in microseconds.
+ */
+uint8_t TM1637::bus_delay() const
+{
+    return delay_us_;
+}
+
+/**
+ * @brief Set the bus half period, e.g. a value stored after calibrate().
+ * @param us Delay between clock and data edges in microseconds (at least 1).
+ */
+void TM1637::set_bus_delay(uint8_t us)
+{
+    TM1637_BUS_ACQUIRE();
+    delay_us_ = std::max(uint8_t(1), us);
+#ifdef TM1637_USE_PIO
+    if (pio_)
+        pio_sm_set_clkdiv(pio_, sm_, float(clock_get_hz(clk_sys)) * delay_us_ / 8e6f);
+#endif
+    TM1637_BUS_RELEASE();
+}
+
+/**
+ * @brief Find the shortest bus half period the chip still handles reliably.
+ * @param margin_pct Safety margin added to the fastest working delay, in percent.
+ * @param trials Number of test transactions that must all pass at a delay.
+ * @return The delay now in use (us), 0 if no delay up to 255 us passed.
+ */
+uint8_t TM1637::calibrate(uint8_t margin_pct, uint16_t trials)
+{
+#ifdef TM1637_USE_PIO
+    // the PIO program cannot sample the ACK slot
+    if (pio_)
+        return delay_us_;
+#endif
+    TM1637_BUS_ACQUIRE();
+    auto passes = [&](uint8_t us)
+    {
+        delay_us_ = us;
+        for (uint16_t t = 0; t < trials; ++t)
+        {
+            nack_seen_ = false;
+            _write_data_cmd();
+            uint8_t code = _read_key();
+            _write_ctrl();
+            if (nack_seen_ || ((code != 0xFF) && (TM1637Keypad::decode(code) < 0)))
+                return false;
+        }
+        return true;
+    };
+
+    uint8_t start = delay_us_;
+    uint8_t fastest = 0;
+    if (passes(start))
+    {
+        // walk down from the current delay until a trial fails
+        fastest = start;
+        for (uint8_t us = start - 1; (us >= 1) && passes(us); --us)
+            fastest = us;
+    }
+    else
+    {
+        // too fast for the wiring: double until a delay passes, then bisect
+        // between the last failing and the first passing one
+        uint8_t failing = start;
+        while (!fastest && (failing < 255))
+        {
+            uint8_t us = uint8_t(std::min(255u, failing * 2u));
+            if (passes(us))
+                fastest = us;
+            else
+                failing = us;
+        }
+        while (fastest && (fastest - failing > 1))
+        {
+            uint8_t us = uint8_t((failing + fastest) / 2);
+            if (passes(us))
+                fastest = us;
+            else
+                failing = us;
+        }
+    }
+    if (fastest)
+        delay_us_ = uint8_t(std::min(255u, (fastest * (100u + margin_pct) + 99u) / 100u));
+    else
+        delay_us_ = start; // nothing passed, keep the previous timing
+    nack_seen_ = false;
+    // failing trials may have left garbage behind, restore the display content
+    ram_dirty_ = true;
+    _repair();
+    TM1637_BUS_RELEASE();
+    return fastest ? delay_us_ : 0;
+}
+
+/**
+ * @brief Set the brightness level of the display.
+ * @param val Brightness level (0-7).
+ * @return The updated brightness level.
+ */
+uint8_t TM1637::brightness(uint8_t val)
+{
+    // Set the display brightness 0-7."
+    // brightness 0 = 1 / 16th pulse width
+    // brightness 7 = 14 / 16th pulse width
+    TM1637_TIME_CALL();
+    TM1637_BUS_ACQUIRE();
+    brightness_ = (val & 0x07);
+    bool ok = _retry([this]()
+                     {
+                         _write_data_cmd();
+                         _write_dsp_ctrl();
+                     });
+    if (ok)
+        _repair();
+    TM1637_TIME_END();
+    TM1637_BUS_RELEASE();
+    return brightness_;
+}
+
+/**
+ * @brief Write segments to the display starting from a specific position.
+ * @param segments Array of 7-segment LED segments.
+ * @param pos Starting position on the display (0-5).
+ */
+void TM1637::write(Segments segments, uint8_t pos)
+{
+    // Display up to 6 segments moving right from a given position.
+    // The MSB in the 2nd segment controls the colon between the 2nd
+    // and 3rd segments.
+    TM1637_TIME_CALL();
+    TM1637_BUS_ACQUIRE();
+    bool ok = _retry([&]()
+                     { _write_frame(segments, pos); });
+    _scan_keys();
+    if (ok)
+        _repair();
+    TM1637_TIME_END();
+    TM1637_BUS_RELEASE();
+}
+
+/**
+ * @brief Send only the digits that differ from the display RAM shadow.
+ * @param segments Six 7-segment LED segments in display order.
+ * @return Number of digits sent.
+ */
+size_t TM1637::write_changed(const uint8_t *segments)
+{
+    TM1637_TIME_CALL();
+    TM1637_BUS_ACQUIRE();
+    // find the span of RAM addresses whose digit changed; the shadow is only
+    // stable while the bus is held
+    size_t first = sizeof(ram_);
+    size_t last = 0;
+    for (size_t addr = 0; addr < sizeof(ram_); ++addr)
+    {
+        if (segments[TM1637Chip::digit_at(addr)] != ram_[addr])
+        {
+            first = std::min(first, addr);
+            last = addr;
+        }
+    }
+    if (first == sizeof(ram_))
+    {
+        TM1637_TIME_END();
+        TM1637_BUS_RELEASE();
+        return 0;
+    }
+
+    bool ok = _retry([&]()
+                     {
+                         _write_data_cmd();
+                         _start();
+                         _write_byte(uint8_t(TM1637_CMD2 | first));
+                         for (size_t addr = first; addr <= last; ++addr)
+                         {
+                             ram_[addr] = segments[TM1637Chip::digit_at(addr)];
+                             _write_byte(ram_[addr]);
+                         }
+                         _stop();
+                     });
+    _scan_keys();
+    if (ok)
+        _repair();
+    TM1637_TIME_END();
+    TM1637_BUS_RELEASE();
+    return last - first + 1;
+}
+
+/**
+ * @brief Configure how NACKed transactions are retried.
+ * @param max_retries Retries after the first attempt before giving up.
+ * @param backoff_us Wait before the first retry, doubled for every further one.
+ */
+void TM1637::set_retry_policy(uint8_t max_retries, uint32_t backoff_us)
+{
+    max_retries_ = max_retries;
+    backoff_us_ = backoff_us;
+}
+
+/**
+ * @brief Re-send the shadow of the display RAM if bus errors were seen since it was last confirmed.
+ * @return true if the display content is confirmed, false if the resend failed too.
+ */
+bool TM1637::repair()
+{
+    TM1637_BUS_ACQUIRE();
+    bool ok = _repair();
+    TM1637_BUS_RELEASE();
+    return ok;
+}
+
+/**
+ * @brief Read the key-scan register (data command 0x42).
+ * @return The raw scan code, 0xFF when no key is pressed.
+ */
+uint8_t TM1637::read_key()
+{
+    TM1637_BUS_ACQUIRE();
+    uint8_t code = _read_key();
+    TM1637_BUS_RELEASE();
+    return code;
+}
+
+/**
+ * @brief Attach a keypad that is fed from the display refresh.
+ * @param keypad Debouncer receiving the scan codes, nullptr to detach.
+ * @param interval_us Minimum time between two scans.
+ */
+void TM1637::attach_keypad(TM1637Keypad *keypad, uint32_t interval_us)
+{
+    keypad_ = keypad;
+    key_interval_us_ = interval_us;
+    key_last_us_ = 0;
+}
+
+/**
+ * @brief Scan the keys for the attached keypad if the interval has elapsed.
+ * @return true if a scan took place.
+ */
+bool TM1637::poll_keys()
+{
+    TM1637_BUS_ACQUIRE();
+    bool scanned = _scan_keys();
+    _repair();
+    TM1637_BUS_RELEASE();
+    return scanned;
+}
+
+/**
+ * @brief Set the bus time the background refresh may use.
+ * @param us_per_s Microseconds of bus time per second, 0 disables scrub().
+ */
+void TM1637::set_scrub_budget(uint32_t us_per_s)
+{
+    scrub_budget_us_ = us_per_s;
+    scrub_tokens_ = 0;
+    scrub_last_us_ = time_us_64();
+}
+
+/**
+ * @brief Re-send one piece of the display RAM shadow within the scrub budget.
+ * @return true if a refresh step was sent.
+ */
+bool TM1637::scrub()
+{
+    if (!scrub_budget_us_)
+        return false;
+
+    // token bucket counted in budget x us, so calls closer together than
+    // 1e6 / budget us still add up: refill at the budget rate, hold at most
+    // one second's worth
+    uint64_t now = time_us_64();
+    uint64_t elapsed = std::min(now - scrub_last_us_, uint64_t(1000000));
+    scrub_last_us_ = now;
+    scrub_tokens_ = std::min(scrub_tokens_ + int64_t(elapsed * scrub_budget_us_),
+                             int64_t(scrub_budget_us_) * 1000000);
+    if (scrub_tokens_ <= 0)
+        return false;
+
+#ifdef TM1637_USE_DMA
+    if (busy())
+        return false;
+#endif
+#ifdef TM1637_THREAD_SAFE
+    if (!_bus_acquire(false))
+        return false;
+#endif
+    nack_seen_ = false;
+    if (scrub_next_ < sizeof(ram_))
+    {
+        // an address command with one byte writes one grid in the default
+        // auto-increment mode too, and leaves the chip in that mode for raw
+        // streams without a data command
+        _write_data_cmd();
+        _start();
+        _write_byte(TM1637_CMD2 | scrub_next_);
+        _write_byte(ram_[scrub_next_]);
+        _stop();
+    }
+    else
+    {
+        _write_ctrl();
+    }
+    scrub_next_ = (scrub_next_ + 1) % (sizeof(ram_) + 1);
+    if (nack_seen_)
+    {
+        // no retries on the budget, the next real update re-sends everything
+        _recover();
+        ram_dirty_ = true;
+    }
+#ifdef TM1637_THREAD_SAFE
+    _bus_release();
+#endif
+
+    uint64_t spent = time_us_64() - now;
+    scrub_tokens_ -= int64_t(spent) * 1000000;
+    TM1637_STAT(++stats_.scrubs);
+    TM1637_STAT(stats_.scrub_us += spent);
+    return true;
+}
+
+/**
+ * @brief Private method to run a bus operation, recovering and retrying it on NACK.
+ * @param op Callable performing complete transactions.
+ * @return true if an attempt went through without NACK. On false the shadow is marked
+ *         dirty and callers leave the resend to the next bus operation.
+ */
+template <class Op>
+bool TM1637::_retry(Op op)
+{
+    for (uint8_t attempt = 0;; ++attempt)
+    {
+        nack_seen_ = false;
+        op();
+        if (!nack_seen_)
+            return true;
+
+        TM1637_STAT(++stats_.nacks);
+#ifdef TM1637_STATS
+        uint64_t t0 = time_us_64();
+#endif
+        _recover();
+        bool give_up = (attempt == max_retries_);
+        if (!give_up)
+        {
+            TM1637_STAT(++stats_.retries);
+            // a 32-bit wait shifted 32 times cannot overflow, the cap applies long before
+            uint64_t wait = uint64_t(backoff_us_) << std::min(attempt, uint8_t(32));
+            sleep_us(std::min(wait, uint64_t(TM1637_MAX_BACKOFF_US)));
+        }
+        TM1637_STAT(stats_.recovery_us += time_us_64() - t0);
+        if (give_up)
+        {
+            // leave it to the consistency check of the next bus operation
+            TM1637_STAT(++stats_.failures);
+            ram_dirty_ = true;
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Private method to re-send the display RAM shadow if errors were seen.
+ * @return true if the display content is confirmed.
+ */
+bool TM1637::_repair()
+{
+    if (!ram_dirty_)
+        return true;
+    TM1637_STAT(++stats_.resends);
+    ram_dirty_ = false;
+    return _retry([this]()
+                  {
+                      _write_data_cmd();
+                      _start();
+                      _write_byte(TM1637_CMD2);
+                      for (size_t i = 0; i < sizeof(ram_); ++i)
+                          _write_byte(ram_[i]);
+                      _stop();
+                      _write_ctrl();
+                  });
+}
+
+/**
+ * @brief Private method to bring the bus back to idle after a failed transaction.
+ */
+void TM1637::_recover()
+{
+#ifdef TM1637_USE_PIO
+    if (pio_)
+        return;
+#endif
+    TM1637_STAT(++stats_.recoveries);
+    // let go of DIO and clock out whatever the chip may still be shifting,
+    // then finish with a stop condition
+    gpio_set_dir_in_masked(dio_mask_);
+    for (int i = 0; i < 9; ++i)
+    {
+        TM1637_LOW(clk_mask_);
+        _delay();
+        TM1637_HIGH(clk_mask_);
+        _delay();
+    }
+    TM1637_LOW(clk_mask_);
+    TM1637_DRIVE(dio_mask_);
+    _stop();
+}
+
+/**
+ * @brief Private method to read the key register with the bus already held.
+ * @return The raw scan code.
+ */
+uint8_t TM1637::_read_key()
+{
+#ifdef TM1637_USE_PIO
+    if (pio_)
+        return 0xFF;
+#endif
+    _start();
+    _write_byte(TM1637_CMD1 | TM1637_READ_KEYS);
+    uint8_t code = _read_byte();
+    _stop();
+    return code;
+}
+
+/**
+ * @brief Private method to scan keys for the attached keypad, bus already held.
+ * @return true if a scan took place.
+ */
+bool TM1637::_scan_keys()
+{
+    if (!keypad_)
+        return false;
+    uint64_t now = time_us_64();
+    if (now - key_last_us_ < key_interval_us_)
+        return false;
+    key_last_us_ = now;
+    nack_seen_ = false;
+    uint8_t code = _read_key();
+    if (nack_seen_)
+    {
+        // a glitched read may have upset the chip, confirm the display content
+        TM1637_STAT(++stats_.nacks);
+        _recover();
+        ram_dirty_ = true;
+        return true;
+    }
+    keypad_->update(code, now);
+    return true;
+}
+
+/**
+ * @brief Send a precompiled transaction stream as is.
+ * @param stream Length-prefixed transactions, see TM1637Frame.
+ * @param len Number of bytes in the stream.
+ */
+void TM1637::write_raw(const uint8_t *stream, size_t len)
+{
+    TM1637_TIME_CALL();
+    TM1637_BUS_ACQUIRE();
+    bool ok = _retry([&]()
+                     {
+                         const uint8_t *p = stream;
+                         const uint8_t *end = stream + len;
+                         while (p < end)
+                         {
+                             size_t n = *p++;
+                             if ((n == 0) || (n > size_t(end - p)))
+                                 break;
+                             // keep the shadows of the display RAM and control in step with the stream
+                             size_t addr = ((p[0] & 0xF0) == TM1637_CMD2) ? (p[0] & 0x0F) : sizeof(ram_);
+                             if ((p[0] & 0xF0) == TM1637_CMD3)
+                                 ctrl_ = p[0];
+                             _start();
+                             _write_byte(*p++);
+                             while (--n)
+                             {
+                                 if (addr < sizeof(ram_))
+                                     ram_[addr++] = *p;
+                                 _write_byte(*p++);
+                             }
+                             _stop();
+                         }
+                     });
+    if (ok)
+        _repair();
+    TM1637_TIME_END();
+    TM1637_BUS_RELEASE();
+}
+
+/**
+ * @brief Private method to send a complete frame: data command, digits and display control.
+ * @param segments Array of 7-segment LED segments.
+ * @param pos Starting position on the display (0-5).
+ */
+void TM1637::_write_frame(const Segments &segments, uint8_t pos)
+{
+    pos = std::min(pos, uint8_t(0x05));
+    _write_data_cmd();
+    _start();
+
+    _write_byte(TM1637_CMD2 | pos);
+
+    // for seg in segments:
+    // _write_byte(seg)
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        uint8_t seg = segments.at(TM1637Chip::digit_at(i));
+        if (pos + i < sizeof(ram_))
+            ram_[pos + i] = seg;
+        _write_byte(seg);
+    }
+
+    _stop();
+    _write_dsp_ctrl();
+}
+
+/**
+ * @brief Encode a decimal digit into a 7-segment LED segment.
+ * @param digit The decimal digit to be encoded (0-9).
+ * @return The encoded 7-segment LED segment.
+ */
+uint8_t TM1637::encode_digit(uint8_t digit)
+{
+    // Convert a character 0-9, a-f to a segment.
+    return (*font_)["0123456789abcdef"[digit & 0x0f]];
+}
+
+/**
+ * @brief Encode a decimal digit into a 7-segment LED segment.
+ * @param digit The decimal digit to be encoded (0-9).
+ * @return The encoded 7-segment LED segment.
+ */
+Segments TM1637::encode_string(std::string str)
+{
+    // Convert a string to LED segments.
+    // Convert an up to 6 character length string containing 0-9, a-z,
+    // space, dash, star and '.' to an array of 6 segments, padded with blanks.
+    Segments segments(TM1637Chip::GRIDS);
+    tm16xx_encode_text<TM1637Chip>(str.data(), str.size(), segments.data(), *font_, fallback_);
+    return segments;
+}
+
+/**
+ * @brief Encode a character into a 7-segment LED segment.
+ * @param ch The input character.
+ * @return The encoded 7-segment LED segment.
+ */
+uint8_t TM1637::encode_char(char ch)
+{
+    return (*font_)[ch];
+}
+
+/**
+ * @brief Select the font used by encode_char(), encode_string() and the text functions.
+ * @param font The font, it must outlive its use by the display.
+ */
+void TM1637::set_font(const TM16xxFont &font)
+{
+    font_ = &font;
+}
+
+/**
+ * @brief Get the font in use.
+ * @return The font, TM16XX_FONT unless set_font() was called.
+ */
+const TM16xxFont &TM1637::font() const
+{
+    return *font_;
+}
+
+/**
+ * @brief Select how encode_string() renders non-ASCII characters without a glyph.
+ * @param fallback TM16XX_FALLBACK_GLYPH (default), TM16XX_FALLBACK_BLANK or TM16XX_FALLBACK_SKIP.
+ */
+void TM1637::set_fallback(TM16xxFallback fallback)
+{
+    fallback_ = fallback;
+}
+
+/**
+ * @brief Display a hexadecimal value on the TM1637 display.
+ * @param val The hexadecimal value (0x0000 - 0xffff).
+ */
+void TM1637::hex(uint16_t val)
+{
+    // Display a hex value 0x0000 through 0xffff, right aligned."
+    write(encode_string(_format_right(val, 16, 6)));
+}
+
+/**
+ * @brief Display a numeric value on the TM1637 display, right aligned.
+ * @param num The numeric value; values above 999999 are auto-ranged like value().
+ */
+void TM1637::number(uint32_t num)
+{
+    write(encode_string(format_value(num)));
+}
+
+/**
+ * @brief Private method formatting a value given as sign, mantissa and decimal exponent.
+ * @param neg The value is negative.
+ * @param m Magnitude mantissa.
+ * @param e10 Decimal exponent, the value is m * 10^e10.
+ * @param digits Number of digits available, including the sign.
+ * @return The formatted text, see format_value().
+ */
+std::string TM1637::_format_value(bool neg, uint64_t m, int e10, uint8_t digits)
+{
+    digits = std::max(uint8_t(1), std::min(digits, uint8_t(TM1637Chip::GRIDS)));
+
+    // decimal digits of m, most significant first, trailing zeros moved into e10
+    char d[20];
+    size_t n = 0;
+    do
+    {
+        d[n++] = char('0' + m % 10);
+        m /= 10;
+    } while (m);
+    std::reverse(d, d + n);
+    while ((n > 1) && (d[n - 1] == '0'))
+    {
+        --n;
+        ++e10;
+    }
+
+    std::string s;
+    int width = int(digits) - (neg ? 1 : 0);
+    int lead = int(n) + e10; // the value is 0.d * 10^lead
+    char sig[20];
+    if ((n == 1) && (d[0] == '0'))
+    {
+        s = "0";
+        neg = false;
+    }
+    else if ((lead >= 1) && (lead <= width))
+    {
+        // plain, as many decimals as fit
+        int l = lead + _round_digits(d, n, size_t(width), sig);
+        if (l <= width)
+            s = _place_digits(sig, size_t(width), l);
+    }
+    else if ((lead <= 0) && (width - 1 + lead >= 2))
+    {
+        // 0.00dd while at least two significant digits remain
+        size_t k = size_t(width - 1 + lead);
+        s = _place_digits(sig, k, lead + _round_digits(d, n, k, sig));
+    }
+
+    if (s.empty() && (lead >= 1) && (width >= 2))
+    {
+        // the largest of k, M, G that leaves an integer part, one digit goes to the suffix
+        static const char SI[] = {'k', 'M', 'G'};
+        size_t k = size_t(width - 1);
+        int l = lead + _round_digits(d, n, k, sig);
+        for (size_t p = sizeof(SI); s.empty() && (p-- > 0);)
+        {
+            int int_digits = l - 3 * int(p + 1);
+            if ((int_digits >= 1) && (int_digits <= width - 1))
+                s = _place_digits(sig, k, int_digits) + SI[p];
+        }
+    }
+
+    if (s.empty())
+    {
+        // d.ddEx, a rounding carry may lengthen the exponent by one digit
+        int e = lead - 1;
+        for (int pass = 0; s.empty() && (pass < 2); ++pass)
+        {
+            std::string exp = (e < 0 ? "-" : "") + _format_right(uint32_t(e < 0 ? -e : e), 10, 0);
+            int k = width - 1 - int(exp.size());
+            if (k < 1)
+                break;
+            if (_round_digits(d, n, size_t(k), sig) && (pass == 0))
+            {
+                e += 1;
+                continue;
+            }
+            s = _place_digits(sig, size_t(k), 1) + 'E' + exp;
+        }
+    }
+
+    if (s.empty())
+    {
+        // too large (or too small) even with an exponent
+        if (lead <= 0)
+        {
+            s = "0";
+            neg = false;
+        }
+        else if (width >= 3)
+            s = "OFL";
+        else
+        {
+            // no room for "OFL" next to the sign, fill the field with dashes
+            s.assign(digits, '-');
+            neg = false;
+        }
+    }
+    if (neg)
+        s.insert(0, 1, '-');
+
+    // right align; a '.' shares the digit before it
+    size_t shown = s.size() - size_t(std::count(s.begin(), s.end(), '.'));
+    if (shown < digits)
+        s.insert(0, digits - shown, ' ');
+    return s;
+}
+
+/**
+ * @brief Private method formatting a floating point value with integer arithmetic only.
+ * @param val The value.
+ * @param digits Number of digits available, including the sign.
+ * @return The formatted text, see format_value().
+ */
+std::string TM1637::_format_value(double val, uint8_t digits)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    bool neg = bits >> 63;
+    int exp = int((bits >> 52) & 0x7FF);
+    uint64_t m = bits & ((uint64_t(1) << 52) - 1);
+    if (exp == 0x7FF)
+    {
+        digits = std::max(uint8_t(1), std::min(digits, uint8_t(TM1637Chip::GRIDS)));
+        std::string s = m ? "nAn" : (neg ? "-Inf" : "Inf");
+        if (s.size() > digits)
+            s.assign(digits, '-');
+        return std::string(digits - s.size(), ' ') + s;
+    }
+    if (exp)
+        m |= uint64_t(1) << 52;
+    else
+        exp = 1; // subnormal
+
+    // turn m * 2^e2 into m * 10^e10, keeping m between 2^59 and 2^63
+    int e2 = exp - 1075;
+    int e10 = 0;
+    while (m && (e2 > 0))
+    {
+        if (m >> 62)
+        {
+            m = (m + 5) / 10;
+            ++e10;
+        }
+        else
+        {
+            m <<= 1;
+            --e2;
+        }
+    }
+    while (m && (e2 < 0))
+    {
+        if (m >> 59)
+            m = (m + 1) >> 1;
+        else
+        {
+            m *= 5; // m * 2^e2 = 5m * 2^(e2 + 1) * 10^-1
+            --e10;
+        }
+        ++e2;
+    }
+    return _format_value(neg, m, e10, digits);
+}
+
+/**
+ * @brief Display a string on the TM1637 display.
+ * @param str The input string.
+ * @param colon Whether to display the colon symbol.
+ */
+void TM1637::show(std::string str, bool colon)
+{
+    Segments segments = encode_string(str);
+    write(segments);
+}
+
+#ifdef TM1637_USE_DMA
+/**
+ * @brief Queue a frame for DMA transmission without blocking.
+ * @param segments Array of 7-segment LED segments, 3 or 6 (whole wiring groups).
+ * @param pos Starting position on the display (0-5).
+ * @param done Optional callback, run from the DMA IRQ once the frame buffer can be reused.
+ * @param user Opaque pointer passed to done.
+ * @return false if both frame buffers are in use, the segment count is not 3 or 6, or the display is not PIO driven.
+ */
+bool TM1637::submit(const Segments &segments, uint8_t pos, TM1637Callback done, void *user)
+{
+    // _write_frame() permutes whole groups of three digits
+    if (segments.empty() || !TM1637Chip::fits(segments.size()))
+        return false;
+    int b = _dma_begin();
+    if (b < 0)
+        return false;
+    _write_frame(segments, pos);
+    _dma_commit(b, done, user);
+    return true;
+}
+
+/**
+ * @brief Queue a brightness change for DMA transmission without blocking.
+ * @param val Brightness level (0-7).
+ * @param done Optional callback, run from the DMA IRQ once the frame buffer can be reused.
+ * @param user Opaque pointer passed to done.
+ * @return false if both frame buffers are in use or the display is not PIO driven.
+ */
+bool TM1637::submit_brightness(uint8_t val, TM1637Callback done, void *user)
+{
+    int b = _dma_begin();
+    if (b < 0)
+        return false;
+    brightness_ = (val & 0x07);
+    _write_data_cmd();
+    _write_dsp_ctrl();
+    _dma_commit(b, done, user);
+    return true;
+}
+
+/**
+ * @brief Private method to claim the free frame buffer and start capturing FIFO words into it.
+ * @return The frame buffer index, or -1 if none is free or the display is not PIO driven.
+ */
+int TM1637::_dma_begin()
+{
+    if (!pio_)
+        return -1;
+#ifdef TM1637_THREAD_SAFE
+    if (!_bus_acquire(false))
+        return -1;
+#endif
+    // with the bus held only the DMA IRQ changes the queue, and it never
+    // touches the buffer that is neither running nor queued
+    uint32_t irq = _dma_lock();
+    bool full = dma_queued_;
+    _dma_unlock(irq);
+    if (full)
+    {
+#ifdef TM1637_THREAD_SAFE
+        _bus_release();
+#endif
+        return -1;
+    }
+
+    if (dma_chan_ < 0)
+    {
+        dma_chan_ = dma_claim_unused_channel(true);
+        _dma_owners[dma_chan_] = this;
+        static bool irq_installed = false;
+        if (!irq_installed)
+        {
+            irq_add_shared_handler(DMA_IRQ_0, _dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            irq_set_enabled(DMA_IRQ_0, true);
+            irq_installed = true;
+        }
+        dma_channel_set_irq0_enabled(dma_chan_, true);
+    }
+
+    // the running transfer owns dma_cur_, the other buffer is free
+    uint8_t b = dma_cur_ ^ 1;
+    pio_capture_ = dma_frames_[b];
+    pio_captured_ = 0;
+    return b;
+}
+
+/**
+ * @brief Private method to stop capturing and start or queue the transfer of a frame buffer.
+ * @param b Frame buffer index returned by _dma_begin().
+ * @param done Optional completion callback.
+ * @param user Opaque pointer passed to done.
+ */
+void TM1637::_dma_commit(uint8_t b, TM1637Callback done, void *user)
+{
+    pio_capture_ = nullptr;
+    dma_len_[b] = pio_captured_;
+    dma_done_[b] = done;
+    dma_user_[b] = user;
+
+    // decide under the lock the IRQ takes, so a completion on the other core
+    // either sees the frame queued or finds the channel already restarted;
+    // the bus is released afterwards, so no other producer claims b meanwhile
+    uint32_t irq = _dma_lock();
+    if (dma_sending_)
+        dma_queued_ = true;
+    else
+        _dma_start(b);
+    _dma_unlock(irq);
+#ifdef TM1637_THREAD_SAFE
+    _bus_release();
+#endif
+}
+
+/**
+ * @brief Check whether submitted frames are still being transferred.
+ * @return true while a DMA transfer is running or queued.
+ */
+bool TM1637::busy() const
+{
+    return dma_sending_ || dma_queued_;
+}
+
+/**
+ * @brief Set a callback run from the DMA IRQ whenever a frame buffer becomes free.
+ * @param free Callback, nullptr to remove it.
+ * @param user Opaque pointer passed to free.
+ */
+void TM1637::set_free_callback(TM1637Callback free, void *user)
+{
+    uint32_t irq = _dma_lock();
+    dma_free_ = free;
+    dma_free_user_ = user;
+    _dma_unlock(irq);
+}
+
+/**
+ * @brief Private method to guard the DMA queue state against the DMA IRQ.
+ * @return The interrupt state to pass to _dma_unlock().
+ */
+uint32_t TM1637::_dma_lock()
+{
+#ifdef TM1637_THREAD_SAFE
+    // the IRQ may run on the other core, masking interrupts is not enough
+    return spin_lock_blocking(lock_);
+#else
+    return save_and_disable_interrupts();
+#endif
+}
+
+/**
+ * @brief Private method to release the guard taken with _dma_lock().
+ * @param irq Interrupt state returned by _dma_lock().
+ */
+void TM1637::_dma_unlock(uint32_t irq)
+{
+#ifdef TM1637_THREAD_SAFE
+    spin_unlock(lock_, irq);
+#else
+    restore_interrupts(irq);
+#endif
+}
+
+/**
+ * @brief Private method to start the DMA transfer of a frame buffer.
+ * @param b Frame buffer index (0 or 1).
+ */
+void TM1637::_dma_start(uint8_t b)
+{
+    dma_channel_config cfg = dma_channel_get_default_config(dma_chan_);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, pio_get_dreq(pio_, sm_, true));
+    dma_cur_ = b;
+    dma_sending_ = true;
+    dma_channel_configure(dma_chan_, &cfg, &pio_->txf[sm_], dma_frames_[b], dma_len_[b], true);
+}
+
+/**
+ * @brief Private method run from the DMA IRQ when a frame transfer completed.
+ */
+void TM1637::_dma_complete()
+{
+    uint32_t irq = _dma_lock();
+    uint8_t b = dma_cur_;
+    dma_sending_ = false;
+    if (dma_queued_)
+    {
+        dma_queued_ = false;
+        _dma_start(b ^ 1);
+    }
+    _dma_unlock(irq);
+    // the callbacks may submit again, so they run without the lock
+    if (dma_done_[b])
+        dma_done_[b](*this, dma_user_[b]);
+    if (dma_free_)
+        dma_free_(*this, dma_free_user_);
+}
+
+/**
+ * @brief DMA IRQ handler dispatching to the display owning the channel.
+ */
+void TM1637::_dma_irq()
+{
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch)
+    {
+        if (_dma_owners[ch] && dma_channel_get_irq0_status(ch))
+        {
+            dma_channel_acknowledge_irq0(ch);
+            _dma_owners[ch]->_dma_complete();
+        }
+    }
+}
+#endif
+
+#ifdef TM1637_THREAD_SAFE
+/**
+ * @brief Store a frame for later transmission; safe from IRQ context and either core.
+ * @param segments Pointer to the 7-segment LED segments.
+ * @param count Number of segments, 3 or 6 (whole wiring groups).
+ * @param pos Starting position on the display (0-5).
+ * @return false if count is not 3 or 6.
+ */
+bool TM1637::defer(const uint8_t *segments, size_t count, uint8_t pos)
+{
+    if ((count == 0) || !TM1637Chip::fits(count))
+        return false;
+    uint32_t irq = spin_lock_blocking(lock_);
+    for (size_t i = 0; i < count; ++i)
+        deferred_[i] = segments[i];
+    deferred_count_ = uint8_t(count);
+    deferred_pos_ = pos;
+    deferred_pending_ = true;
+    spin_unlock(lock_, irq);
+    return true;
+}
+
+/**
+ * @brief Transmit the frame stored by defer(), if any. Not for IRQ context.
+ * @return true if a frame was written.
+ */
+bool TM1637::flush()
+{
+    if (!deferred_pending_)
+        return false;
+    uint32_t irq = spin_lock_blocking(lock_);
+    Segments segments(deferred_, deferred_ + deferred_count_);
+    uint8_t pos = deferred_pos_;
+    deferred_pending_ = false;
+    spin_unlock(lock_, irq);
+    write(segments, pos);
+    return true;
+}
+
+/**
+ * @brief Private method to initialise the spinlock and deferred frame state.
+ */
+void TM1637::_init_lock()
+{
+    lock_ = spin_lock_init(spin_lock_claim_unused(true));
+    bus_busy_ = false;
+    deferred_count_ = 0;
+    deferred_pos_ = 0;
+    deferred_pending_ = false;
+}
+
+/**
+ * @brief Private method to take exclusive use of the bus.
+ * @param wait Spin until the bus is free instead of giving up.
+ * @return true if the bus was taken.
+ */
+bool TM1637::_bus_acquire(bool wait)
+{
+    // the spinlock only guards the flag, the bus sequence itself runs with
+    // interrupts enabled
+    do
+    {
+        uint32_t irq = spin_lock_blocking(lock_);
+        bool taken = !bus_busy_;
+        bus_busy_ = true;
+        spin_unlock(lock_, irq);
+        if (taken)
+            return true;
+        tight_loop_contents();
+    } while (wait);
+    return false;
+}
+
+/**
+ * @brief Private method to give up the bus taken with _bus_acquire().
+ */
+void TM1637::_bus_release()
+{
+    uint32_t irq = spin_lock_blocking(lock_);
+    bus_busy_ = false;
+    spin_unlock(lock_, irq);
+}
+#endif
+
+#ifdef TM1637_STATS
+/**
+ * @brief Get the bus accounting collected since construction or the last reset.
+ * @return The accumulated statistics.
+ */
+const TM1637Stats &TM1637::stats() const
+{
+    return stats_;
+}
+
+/**
+ * @brief Reset the bus accounting to zero.
+ */
+void TM1637::reset_stats()
+{
+    stats_ = TM1637Stats();
+}
+#endif
@@ -1,120 +1,663 @@
-/**
- * @file my_tm1637.hpp
- * @brief Header file for the TM1637 class for controlling a 4-digit 7-segment display.
- */
-
-#ifndef MY_TM1637_HPP
-#define MY_TM1637_HPP
-
-#include <cstdint>
-#include <string>
-#include <vector>
-
-/**
- * @typedef Segments
- * @brief Type definition for an array of 7-segment LED segments.
- */
-typedef std::vector<uint8_t> Segments;
-
-/**
- * @class TM1637
- * @brief Class for controlling a 4-digit 7-segment display using the TM1637 driver.
- */
-class TM1637
-{
-public:
-    /**
-     * @brief Constructor for the TM1637 class.
-     * @param clk Pin number for the clock (CLK) line.
-     * @param dio Pin number for the data (DIO) line.
-     * @param brightness Brightness level for the display (0-7).
-     */
-    TM1637(uint8_t clk, uint8_t dio, uint8_t brightness = 7);
-
-    /**
-     * @brief Set the brightness level of the display.
-     * @param val Brightness level (0-7).
-     * @return The updated brightness level.
-     */
-    uint8_t brightness(uint8_t val = 4);
-
-    /**
-     * @brief Write segments to the display starting from a specific position.
-     * @param segments Array of 7-segment LED segments.
-     * @param pos Starting position on the display (0-5).
-     */
-    void write(Segments segments, uint8_t pos = 0);
-
-    /**
-     * @brief Encode a decimal digit into a 7-segment LED segment.
-     * @param digit The decimal digit to be encoded (0-9).
-     * @return The encoded 7-segment LED segment.
-     */
-    uint8_t encode_digit(uint8_t digit);
-
-    /**
-     * @brief Encode a string into an array of 7-segment LED segments.
-     * @param str The input string.
-     * @return Array of 7-segment LED segments.
-     */
-    Segments encode_string(std::string str);
-
-    /**
-     * @brief Encode a character into a 7-segment LED segment.
-     * @param ch The input character.
-     * @return The encoded 7-segment LED segment.
-     */
-    uint8_t encode_char(char ch);
-
-    /**
-     * @brief Display a hexadecimal value on the TM1637 display.
-     * @param val The hexadecimal value (0x0000 - 0xffff).
-     */
-    void hex(uint16_t val);
-
-    /**
-     * @brief Display a numeric value on the TM1637 display.
-     * @param num The numeric value (-999 to 9999).
-     */
-    void number(uint32_t num);
-
-    /**
-     * @brief Display a string on the TM1637 display.
-     * @param str The input string.
-     * @param colon Whether to display the colon symbol.
-     */
-    void show(std::string str, bool colon = false);
-
-private:
-    uint8_t clk_;        ///< Pin number for the clock (CLK) line.
-    uint8_t dio_;        ///< Pin number for the data (DIO) line.
-    uint8_t brightness_; ///< Brightness level for the display (0-7).
-
-    /**
-     * @brief Private method to start communication with the TM1637.
-     */
-    void _start();
-
-    /**
-     * @brief Private method to stop communication with the TM1637.
-     */
-    void _stop();
-
-    /**
-     * @brief Private method to send the data command to the TM1637.
-     */
-    void _write_data_cmd();
-
-    /**
-     * @brief Private method to send the display control command to the TM1637.
-     */
-    void _write_dsp_ctrl();
-
-    /**
-     * @brief Private method to write a byte to the TM1637.
-     * @param b The byte to be written.
-     */
-    void _write_byte(uint8_t b);
-};
-
-#endif // MY_TM1637_HPP
+/**
+ * @file my_tm1637.hpp
+ * @brief Header file for the TM1637 class for controlling a 4-digit 7-segment display.
+ */
+
+#ifndef MY_TM1637_HPP
+#define MY_TM1637_HPP
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "tm1637_frame.hpp"
+#include "tm1637_keys.hpp"
+
+#ifdef TM1637_USE_PIO
+#include <hardware/pio.h>
+#endif
+
+#ifdef TM1637_THREAD_SAFE
+#include <hardware/sync.h>
+#endif
+
+#if defined(TM1637_USE_DMA) && !defined(TM1637_USE_PIO)
+#error "TM1637_USE_DMA requires TM1637_USE_PIO"
+#endif
+
+#ifdef TM1637_USE_DMA
+class TM1637;
+
+/**
+ * @typedef TM1637Callback
+ * @brief Completion callback for frames submitted with TM1637::submit(), called from the DMA IRQ.
+ */
+typedef void (*TM1637Callback)(TM1637 &display, void *user);
+
+/**
+ * @brief Number of PIO FIFO words in one frame: data command, address, 6 digits and display control.
+ */
+const size_t TM1637_FRAME_WORDS = 9;
+#endif
+
+/**
+ * @brief Longest wait between two retries (us); the doubling backoff stops growing there.
+ */
+const uint32_t TM1637_MAX_BACKOFF_US = 100000;
+
+/**
+ * @typedef Segments
+ * @brief Type definition for an array of 7-segment LED segments.
+ */
+typedef std::vector<uint8_t> Segments;
+
+#ifdef TM1637_STATS
+/**
+ * @struct TM1637Stats
+ * @brief Bus accounting collected when the driver is built with TM1637_STATS.
+ */
+struct TM1637Stats
+{
+    uint32_t transactions; ///< Start/stop framed transactions sent.
+    uint32_t bytes;        ///< Bytes shifted out, excluding ACK slots.
+    uint32_t bit_times;    ///< Clock pulses issued, including ACK slots.
+    uint64_t sleep_us;     ///< Total time spent in blocking bus delays (us).
+    uint32_t max_call_us;  ///< Longest single blocking write() or brightness() call (us).
+    uint32_t nacks;        ///< Attempts that saw a byte without ACK.
+    uint32_t retries;      ///< Attempts repeated after a NACK.
+    uint32_t recoveries;   ///< Bus recovery sequences (extra clocks plus stop).
+    uint32_t resends;      ///< Display RAM shadow re-sent after errors.
+    uint32_t failures;     ///< Operations given up after all retries.
+    uint64_t recovery_us;  ///< Time spent recovering and backing off (us).
+    uint32_t scrubs;       ///< Background refresh steps sent by scrub().
+    uint64_t scrub_us;     ///< Bus time spent on background refresh (us).
+};
+#endif
+
+/**
+ * @class TM1637
+ * @brief Class for controlling a 4-digit 7-segment display using the TM1637 driver.
+ */
+class TM1637
+{
+public:
+    /**
+     * @brief Constructor for the TM1637 class.
+     * @param clk Pin number for the clock (CLK) line.
+     * @param dio Pin number for the data (DIO) line.
+     * @param brightness Brightness level for the display (0-7).
+     */
+    TM1637(uint8_t clk, uint8_t dio, uint8_t brightness = 7);
+
+#ifdef TM1637_USE_PIO
+    /**
+     * @brief Constructor for a TM1637 driven by a PIO state machine instead of bit-banging.
+     * @param clk Pin number for the clock (CLK) line.
+     * @param dio Pin number for the data (DIO) line.
+     * @param pio PIO instance running the tm1637 program.
+     * @param sm State machine index to claim on that PIO.
+     * @param brightness Brightness level for the display (0-7).
+     */
+    TM1637(uint8_t clk, uint8_t dio, PIO pio, uint sm, uint8_t brightness = 7);
+#endif
+
+    /**
+     * @brief Set the brightness level of the display.
+     * @param val Brightness level (0-7).
+     * @return The updated brightness level.
+     */
+    uint8_t brightness(uint8_t val = 4);
+
+    /**
+     * @brief Get the bus half period in use.
+     * @return The delay between clock and data edges in microseconds.
+     */
+    uint8_t bus_delay() const;
+
+    /**
+     * @brief Set the bus half period, e.g. a value stored after calibrate().
+     * @param us Delay between clock and data edges in microseconds (at least 1).
+     */
+    void set_bus_delay(uint8_t us);
+
+    /**
+     * @brief Find the shortest bus half period the chip still handles reliably.
+     *
+     * A delay passes when every trial transaction is acknowledged and the
+     * key register reads back a valid code. If the current delay passes, it
+     * is lowered 1 us at a time until one fails; if it fails, it is doubled
+     * until one passes and the range is bisected. The fastest passing delay
+     * plus the margin is applied; store bus_delay() and restore it with
+     * set_bus_delay() at boot to skip calibration. PIO driven displays keep
+     * their timing.
+     * @param margin_pct Safety margin added to the fastest working delay, in percent.
+     * @param trials Number of test transactions that must all pass at a delay.
+     * @return The delay now in use (us), 0 if no delay up to 255 us passed
+     *         (the previous delay is kept).
+     */
+    uint8_t calibrate(uint8_t margin_pct = 50, uint16_t trials = 16);
+
+    /**
+     * @brief Write segments to the display starting from a specific position.
+     * @param segments Array of 7-segment LED segments.
+     * @param pos Starting position on the display (0-5).
+     */
+    void write(Segments segments, uint8_t pos = 0);
+
+    /**
+     * @brief Send only the digits that differ from the display RAM shadow.
+     *
+     * The changed digits are sent as one address span without a display
+     * control command, so an update touching one digit costs two short
+     * transactions instead of a full frame.
+     * @param segments Six 7-segment LED segments in display order.
+     * @return Number of digits sent.
+     */
+    size_t write_changed(const uint8_t *segments);
+
+    /**
+     * @brief Send a precompiled transaction stream as is.
+     *
+     * No encoding or digit permutation takes place; the stream's display
+     * control byte sets the brightness on the chip, brightness() keeps its
+     * own value.
+     * @param stream Length-prefixed transactions, see TM1637Frame.
+     * @param len Number of bytes in the stream.
+     */
+    void write_raw(const uint8_t *stream, size_t len);
+
+    /**
+     * @brief Send a frame built at compile time with tm1637_frame().
+     * @param frame The precompiled frame.
+     */
+    template <size_t N>
+    void write_raw(const TM1637Frame<N> &frame)
+    {
+        write_raw(frame.bytes, frame.size());
+    }
+
+    /**
+     * @brief Encode a decimal digit into a 7-segment LED segment.
+     * @param digit The decimal digit to be encoded (0-9).
+     * @return The encoded 7-segment LED segment.
+     */
+    uint8_t encode_digit(uint8_t digit);
+
+    /**
+     * @brief Encode a string into an array of 7-segment LED segments.
+     * @param str The input string.
+     * @return Array of 7-segment LED segments.
+     */
+    Segments encode_string(std::string str);
+
+    /**
+     * @brief Encode a character into a 7-segment LED segment.
+     * @param ch The input character.
+     * @return The encoded 7-segment LED segment.
+     */
+    uint8_t encode_char(char ch);
+
+    /**
+     * @brief Select the font used by encode_char(), encode_string() and the text functions.
+     *
+     * The display keeps a pointer, so glyphs changed later with
+     * TM16xxFont::set() take effect on the next update.
+     * @param font The font, it must outlive its use by the display.
+     */
+    void set_font(const TM16xxFont &font);
+
+    /**
+     * @brief Get the font in use.
+     * @return The font, TM16XX_FONT unless set_font() was called.
+     */
+    const TM16xxFont &font() const;
+
+    /**
+     * @brief Select how encode_string() renders non-ASCII characters without a glyph.
+     *
+     * Strings are decoded as UTF-8; code points in the font (see
+     * TM16xxFont::with_code_point()) or in TM16XX_GLYPHS (degree sign,
+     * micro sign, umlauts, dashes, quotes) get their own glyph.
+     * @param fallback TM16XX_FALLBACK_GLYPH (default), TM16XX_FALLBACK_BLANK or TM16XX_FALLBACK_SKIP.
+     */
+    void set_fallback(TM16xxFallback fallback);
+
+    /**
+     * @brief Display a hexadecimal value on the TM1637 display.
+     * @param val The hexadecimal value (0x0000 - 0xffff).
+     */
+    void hex(uint16_t val);
+
+    /**
+     * @brief Display a numeric value on the TM1637 display, right aligned.
+     * @param num The numeric value; values above 999999 are auto-ranged like value().
+     */
+    void number(uint32_t num);
+
+    /**
+     * @brief Format any integer or floating point value to fit a number of digits.
+     *
+     * Uses integer arithmetic only, floating point values are decomposed
+     * from their bits. In order of preference the result is the plain
+     * number with as many decimals as fit ("3.14159", "-0.0012"), a
+     * k, M or G suffix ("12.35M"), or an exponent ("1.2E15", "5E-9").
+     * Values too large for that read "OFL" (overflow), values too small
+     * "0"; NaN and infinities read "nAn" and "Inf". Where that text does
+     * not fit the digits, the field is filled with dashes ("--" for
+     * 123456 on two digits, "-" for -5 on one). The result is right
+     * aligned with spaces; a '.' lights the decimal point of the digit
+     * before it and takes no digit of its own.
+     * @param val The value.
+     * @param digits Number of digits available (1-6), including the sign.
+     * @return The text for encode_string() or show().
+     */
+    template <class T>
+    static std::string format_value(T val, uint8_t digits = 6);
+
+    /**
+     * @brief Display any integer or floating point value, auto-ranged with format_value().
+     * @param val The value.
+     */
+    template <class T>
+    void value(T val)
+    {
+        show(format_value(val));
+    }
+
+    /**
+     * @brief Display a string on the TM1637 display.
+     * @param str The input string.
+     * @param colon Whether to display the colon symbol.
+     */
+    void show(std::string str, bool colon = false);
+
+    /**
+     * @brief Configure how NACKed transactions are retried.
+     *
+     * After a NACK the bus is recovered (DIO released, 9 clocks, stop), the
+     * driver waits backoff_us, doubling for every further retry up to
+     * TM1637_MAX_BACKOFF_US, and repeats the whole operation. When all
+     * retries fail the next bus operation re-sends the shadow of the display RAM.
+     * @param max_retries Retries after the first attempt before giving up.
+     * @param backoff_us Wait before the first retry, doubled for every further one.
+     */
+    void set_retry_policy(uint8_t max_retries, uint32_t backoff_us);
+
+    /**
+     * @brief Re-send the shadow of the display RAM if bus errors were seen since it was last confirmed.
+     * @return true if the display content is confirmed, false if the resend failed too.
+     */
+    bool repair();
+
+    /**
+     * @brief Set the bus time the background refresh may use.
+     * @param us_per_s Microseconds of bus time per second, 0 disables scrub().
+     */
+    void set_scrub_budget(uint32_t us_per_s);
+
+    /**
+     * @brief Re-send one piece of the display RAM shadow within the scrub budget.
+     *
+     * Call it from the idle loop or a timer, as often as convenient: the budget
+     * accumulates between calls. Each call that fits the budget rewrites one
+     * grid or, after the last grid, the last display control byte sent, so
+     * display RAM corrupted by ESD is restored without waiting for new
+     * content. The call does nothing when the bus is in use or the budget is
+     * exhausted.
+     * @return true if a refresh step was sent.
+     */
+    bool scrub();
+
+    /**
+     * @brief Read the key-scan register (data command 0x42).
+     *
+     * Only bit-banged displays can read; a PIO driven display reports no key.
+     * @return The raw scan code, 0xFF when no key is pressed. See TM1637Keypad::decode().
+     */
+    uint8_t read_key();
+
+    /**
+     * @brief Attach a keypad that is fed from the display refresh.
+     *
+     * After every write() the key register is read and passed to the keypad,
+     * at most once per interval, so key scanning piggybacks on frame updates.
+     * Call poll_keys() when the display is not refreshed often enough.
+     * @param keypad Debouncer receiving the scan codes, nullptr to detach.
+     * @param interval_us Minimum time between two scans.
+     */
+    void attach_keypad(TM1637Keypad *keypad, uint32_t interval_us = 10000);
+
+    /**
+     * @brief Scan the keys for the attached keypad if the interval has elapsed.
+     * @return true if a scan took place.
+     */
+    bool poll_keys();
+
+#ifdef TM1637_USE_DMA
+    /**
+     * @brief Queue a frame for DMA transmission without blocking.
+     *
+     * The frame is built into whichever of the two frame buffers is free and
+     * sent as one DMA transfer into the PIO TX FIFO. While one frame is on its
+     * way the next can be submitted; it starts from the DMA IRQ as soon as the
+     * current one completes.
+     * @param segments Array of 7-segment LED segments, 3 or 6 (whole wiring
+     *                 groups, see TM1637Chip::fits()).
+     * @param pos Starting position on the display (0-5).
+     * @param done Optional callback, run from the DMA IRQ once the frame buffer
+     *             has been handed to the state machine and can be reused.
+     * @param user Opaque pointer passed to done.
+     * @return false if both frame buffers are in use, the segment count is not
+     *         3 or 6, or the display is not PIO driven.
+     */
+    bool submit(const Segments &segments, uint8_t pos = 0, TM1637Callback done = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Queue a brightness change for DMA transmission without blocking.
+     * @param val Brightness level (0-7).
+     * @param done Optional callback, run from the DMA IRQ once the frame buffer can be reused.
+     * @param user Opaque pointer passed to done.
+     * @return false if both frame buffers are in use or the display is not PIO driven.
+     */
+    bool submit_brightness(uint8_t val, TM1637Callback done = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Check whether submitted frames are still being transferred.
+     * @return true while a DMA transfer is running or queued.
+     */
+    bool busy() const;
+
+    /**
+     * @brief Set a callback run from the DMA IRQ whenever a frame buffer becomes free.
+     *
+     * Lets a producer that found both buffers in use wait for the next
+     * submit() to succeed instead of polling it. It runs after the done
+     * callback of the frame that freed the buffer.
+     * @param free Callback, nullptr to remove it.
+     * @param user Opaque pointer passed to free.
+     */
+    void set_free_callback(TM1637Callback free, void *user = nullptr);
+#endif
+
+#ifdef TM1637_THREAD_SAFE
+    /**
+     * @brief Store a frame for later transmission; safe from IRQ context and either core.
+     *
+     * Only copies the segments under the instance spinlock, the bus is not
+     * touched. A frame deferred before the previous one was flushed replaces it.
+     * @param segments Pointer to the 7-segment LED segments.
+     * @param count Number of segments, 3 or 6 (whole wiring groups, see TM1637Chip::fits()).
+     * @param pos Starting position on the display (0-5).
+     * @return false if count is not 3 or 6.
+     */
+    bool defer(const uint8_t *segments, size_t count, uint8_t pos = 0);
+
+    /**
+     * @brief Transmit the frame stored by defer(), if any. Not for IRQ context.
+     * @return true if a frame was written.
+     */
+    bool flush();
+#endif
+
+#ifdef TM1637_STATS
+    /**
+     * @brief Get the bus accounting collected since construction or the last reset.
+     * @return The accumulated statistics.
+     */
+    const TM1637Stats &stats() const;
+
+    /**
+     * @brief Reset the bus accounting to zero.
+     */
+    void reset_stats();
+#endif
+
+private:
+    /**
+     * @brief Private method formatting a value given as sign, mantissa and decimal exponent.
+     * @param neg The value is negative.
+     * @param m Magnitude mantissa.
+     * @param e10 Decimal exponent, the value is m * 10^e10.
+     * @param digits Number of digits available, including the sign.
+     * @return The formatted text, see format_value().
+     */
+    static std::string _format_value(bool neg, uint64_t m, int e10, uint8_t digits);
+
+    /**
+     * @brief Private method formatting a floating point value with integer arithmetic only.
+     * @param val The value.
+     * @param digits Number of digits available, including the sign.
+     * @return The formatted text, see format_value().
+     */
+    static std::string _format_value(double val, uint8_t digits);
+
+    uint8_t clk_;        ///< Pin number for the clock (CLK) line.
+    uint8_t dio_;        ///< Pin number for the data (DIO) line.
+    uint8_t brightness_; ///< Brightness level for the display (0-7).
+    const TM16xxFont *font_; ///< Font used for encoding, owned by the caller.
+    TM16xxFallback fallback_; ///< Rendering of non-ASCII characters without a glyph.
+    uint32_t clk_mask_;  ///< SIO bit mask of the clock (CLK) pin.
+    uint32_t dio_mask_;  ///< SIO bit mask of the data (DIO) pin.
+    TM1637Keypad *keypad_;     ///< Keypad fed from the refresh, nullptr if none.
+    uint32_t key_interval_us_; ///< Minimum time between two key scans.
+    uint64_t key_last_us_;     ///< Time of the last key scan.
+    uint8_t delay_us_;         ///< Bus half period in microseconds.
+    bool nack_seen_;           ///< Sticky flag, set when a byte was not acknowledged.
+    uint8_t ram_[TM1637Chip::GRIDS]; ///< Shadow of the display RAM, by grid address.
+    uint8_t ctrl_;             ///< Last display control byte sent, including one from write_raw().
+    bool ram_dirty_;           ///< Bus errors were seen, ram_ has to be re-sent.
+    uint8_t max_retries_;      ///< Retries after a NACK.
+    uint32_t backoff_us_;      ///< Wait before the first retry.
+    uint32_t scrub_budget_us_; ///< Bus time per second available to scrub().
+    int64_t scrub_tokens_;     ///< Bus time scrub() may still spend (us x 1e6), negative while in debt.
+    uint64_t scrub_last_us_;   ///< Time of the last budget refill.
+    uint8_t scrub_next_;       ///< Next grid to refresh, GRIDS for the control byte.
+#ifdef TM1637_USE_PIO
+    PIO pio_;            ///< PIO transmitting the bus traffic, nullptr when bit-banging.
+    uint sm_;            ///< State machine index on pio_.
+    uint32_t pio_word_;  ///< FIFO word of the last byte, held back until the next byte or stop.
+    bool pio_start_;     ///< A start condition is due before the next byte.
+    uint32_t *pio_capture_; ///< When set, FIFO words are collected here instead of pushed.
+    size_t pio_captured_;   ///< Number of words collected in pio_capture_.
+#endif
+#ifdef TM1637_USE_DMA
+    int dma_chan_;                                      ///< DMA channel feeding the TX FIFO, -1 until first use.
+    uint32_t dma_frames_[2][TM1637_FRAME_WORDS];        ///< Double buffered frames.
+    size_t dma_len_[2];                                 ///< Words in each frame buffer.
+    TM1637Callback dma_done_[2];                        ///< Completion callback per frame buffer.
+    void *dma_user_[2];                                 ///< Callback argument per frame buffer.
+    TM1637Callback dma_free_;                           ///< Callback for a frame buffer becoming free.
+    void *dma_free_user_;                               ///< Argument of dma_free_.
+    volatile uint8_t dma_cur_;                          ///< Frame buffer sent last or being sent.
+    volatile bool dma_sending_;                         ///< A transfer is running.
+    volatile bool dma_queued_;                          ///< The other buffer waits for the running transfer.
+#endif
+#ifdef TM1637_STATS
+    TM1637Stats stats_; ///< Bus accounting, only present with TM1637_STATS.
+#endif
+#ifdef TM1637_THREAD_SAFE
+    spin_lock_t *lock_;          ///< Guards bus_busy_, the deferred frame and the DMA queue state.
+    volatile bool bus_busy_;     ///< A core is in the middle of a bus sequence.
+    uint8_t deferred_[6];        ///< Frame stored by defer().
+    uint8_t deferred_count_;     ///< Segments in deferred_.
+    uint8_t deferred_pos_;       ///< Start position of the deferred frame.
+    volatile bool deferred_pending_; ///< deferred_ holds a frame not flushed yet.
+#endif
+
+    /**
+     * @brief Private method to start communication with the TM1637.
+     */
+    void _start();
+
+    /**
+     * @brief Private method to stop communication with the TM1637.
+     */
+    void _stop();
+
+    /**
+     * @brief Private method to send the data command to the TM1637.
+     */
+    void _write_data_cmd();
+
+    /**
+     * @brief Private method to send the display control command to the TM1637.
+     */
+    void _write_dsp_ctrl();
+
+    /**
+     * @brief Private method to re-send the last display control byte, which may have switched the display off.
+     */
+    void _write_ctrl();
+
+    /**
+     * @brief Private method to write a byte to the TM1637.
+     * @param b The byte to be written.
+     * @return true if the chip acknowledged the byte (always true on a PIO driven display).
+     */
+    bool _write_byte(uint8_t b);
+
+    /**
+     * @brief Private method to read a byte from the TM1637, DIO released to the chip.
+     * @return The byte read, LSB first.
+     */
+    uint8_t _read_byte();
+
+    /**
+     * @brief Private method to run a bus operation, recovering and retrying it on NACK.
+     * @param op Callable performing complete transactions.
+     * @return true if an attempt went through without NACK. On false the shadow is marked
+     *         dirty and callers leave the resend to the next bus operation.
+     */
+    template <class Op>
+    bool _retry(Op op);
+
+    /**
+     * @brief Private method to re-send the display RAM shadow if errors were seen.
+     * @return true if the display content is confirmed.
+     */
+    bool _repair();
+
+    /**
+     * @brief Private method to bring the bus back to idle after a failed transaction.
+     */
+    void _recover();
+
+    /**
+     * @brief Private method to read the key register with the bus already held.
+     * @return The raw scan code.
+     */
+    uint8_t _read_key();
+
+    /**
+     * @brief Private method to scan keys for the attached keypad, bus already held.
+     * @return true if a scan took place.
+     */
+    bool _scan_keys();
+
+    /**
+     * @brief Private method to send a complete frame: data command, digits and display control.
+     * @param segments Array of 7-segment LED segments.
+     * @param pos Starting position on the display (0-5).
+     */
+    void _write_frame(const Segments &segments, uint8_t pos);
+
+    /**
+     * @brief Private method to wait one bus half period (bus_delay()).
+     */
+    void _delay();
+
+#ifdef TM1637_THREAD_SAFE
+    /**
+     * @brief Private method to initialise the spinlock and deferred frame state.
+     */
+    void _init_lock();
+
+    /**
+     * @brief Private method to take exclusive use of the bus.
+     * @param wait Spin until the bus is free instead of giving up.
+     * @return true if the bus was taken.
+     */
+    bool _bus_acquire(bool wait);
+
+    /**
+     * @brief Private method to give up the bus taken with _bus_acquire().
+     */
+    void _bus_release();
+#endif
+
+#ifdef TM1637_USE_PIO
+    /**
+     * @brief Private method to hand one word to the state machine, or to the frame being captured.
+     * @param word FIFO word as consumed by tm1637.pio.
+     */
+    void _pio_put(uint32_t word);
+#endif
+
+#ifdef TM1637_USE_DMA
+    /**
+     * @brief Private method to claim the free frame buffer and start capturing FIFO words into it.
+     * @return The frame buffer index, or -1 if none is free or the display is not PIO driven.
+     */
+    int _dma_begin();
+
+    /**
+     * @brief Private method to stop capturing and start or queue the transfer of a frame buffer.
+     * @param b Frame buffer index returned by _dma_begin().
+     * @param done Optional completion callback.
+     * @param user Opaque pointer passed to done.
+     */
+    void _dma_commit(uint8_t b, TM1637Callback done, void *user);
+
+    /**
+     * @brief Private method to start the DMA transfer of a frame buffer.
+     * @param b Frame buffer index (0 or 1).
+     */
+    void _dma_start(uint8_t b);
+
+    /**
+     * @brief Private method run from the DMA IRQ when a frame transfer completed.
+     */
+    void _dma_complete();
+
+    /**
+     * @brief Private method to guard the DMA queue state against the DMA IRQ.
+     *
+     * With TM1637_THREAD_SAFE this is the instance spinlock, since the IRQ
+     * may run on the other core; otherwise interrupts are masked.
+     * @return The interrupt state to pass to _dma_unlock().
+     */
+    uint32_t _dma_lock();
+
+    /**
+     * @brief Private method to release the guard taken with _dma_lock().
+     * @param irq Interrupt state returned by _dma_lock().
+     */
+    void _dma_unlock(uint32_t irq);
+
+    /**
+     * @brief DMA IRQ handler dispatching to the display owning the channel.
+     */
+    static void _dma_irq();
+#endif
+};
+
+/**
+ * @brief Format any integer or floating point value to fit a number of digits.
+ * @param val The value.
+ * @param digits Number of digits available (1-6), including the sign.
+ * @return The text for encode_string() or show().
+ */
+template <class T>
+std::string TM1637::format_value(T val, uint8_t digits)
+{
+    static_assert(std::is_arithmetic<T>::value, "format_value() takes integer or floating point values");
+    if constexpr (std::is_floating_point<T>::value)
+        return _format_value(double(val), digits);
+    else if constexpr (std::is_signed<T>::value)
+        return _format_value(val < 0, val < 0 ? 0 - uint64_t(val) : uint64_t(val), 0, digits);
+    else
+        return _format_value(false, uint64_t(val), 0, digits);
+}
+
+#endif // MY_TM1637_HPP
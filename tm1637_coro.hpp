@@ -0,0 +1,360 @@
+/**
+ * @file tm1637_coro.hpp
+ * @brief C++20 coroutine API for non-blocking TM1637 updates.
+ *
+ * Requires a PIO driven display built with TM1637_USE_DMA: a coroutine
+ * awaiting write_async(), show_async() or brightness_async() stays suspended
+ * until the DMA has handed its frame to the PIO TX FIFO and is resumed by
+ * TM1637Executor from the DMA completion callback. The state machine may
+ * still be clocking the last bytes out at that point. A coroutine that
+ * finds both frame buffers in use waits for the display's buffer-free
+ * callback instead of polling.
+ */
+
+#ifndef TM1637_CORO_HPP
+#define TM1637_CORO_HPP
+
+#include "tm1637.hpp"
+
+#ifndef TM1637_USE_DMA
+#error "tm1637_coro.hpp requires TM1637_USE_DMA"
+#endif
+
+#if !defined(__cpp_impl_coroutine)
+#error "tm1637_coro.hpp requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <hardware/sync.h>
+
+class TM1637Executor;
+
+/**
+ * @class TM1637Task
+ * @brief Lazily started coroutine returning nothing, awaitable from another TM1637Task.
+ */
+class TM1637Task
+{
+public:
+    /**
+     * @brief Coroutine promise: remembers who awaits the task, or the executor owning it.
+     */
+    struct promise_type
+    {
+        std::coroutine_handle<> continuation; ///< Coroutine resumed when this one finishes.
+        TM1637Executor *executor = nullptr;   ///< Owner of a spawned top-level task.
+
+        TM1637Task get_return_object()
+        {
+            return TM1637Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        /**
+         * @brief Resume the awaiting coroutine, or retire a spawned task.
+         */
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept;
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    TM1637Task(TM1637Task &&other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    TM1637Task(const TM1637Task &) = delete;
+    TM1637Task &operator=(const TM1637Task &) = delete;
+    ~TM1637Task()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    void await_resume() const noexcept {}
+
+private:
+    friend class TM1637Executor;
+
+    explicit TM1637Task(std::coroutine_handle<promise_type> h) : handle_(h) {}
+
+    std::coroutine_handle<promise_type> handle_; ///< Owned coroutine, null once moved or spawned.
+};
+
+/**
+ * @class TM1637Executor
+ * @brief Minimal single-threaded executor for display coroutines.
+ *
+ * Every task is either in the ready queue or waiting for a frame buffer,
+ * at most once, so N entries each serve up to N concurrently spawned
+ * tasks. post() may be called from the DMA IRQ.
+ */
+class TM1637Executor
+{
+public:
+    static const size_t N = 16; ///< Maximum number of live tasks.
+
+    /**
+     * @brief Take ownership of a task and schedule it.
+     * @param task The task to run.
+     * @return false if N tasks are already live.
+     */
+    bool spawn(TM1637Task task)
+    {
+        if (live_ == N)
+            return false;
+        std::coroutine_handle<TM1637Task::promise_type> h = task.handle_;
+        task.handle_ = nullptr;
+        h.promise().executor = this;
+        ++live_;
+        post(h);
+        return true;
+    }
+
+    /**
+     * @brief Make a suspended coroutine ready to run; safe from IRQ context.
+     * @param h The coroutine to resume.
+     */
+    void post(std::coroutine_handle<> h)
+    {
+        uint32_t irq = save_and_disable_interrupts();
+        ready_[(head_ + count_) % N] = h;
+        ++count_;
+        restore_interrupts(irq);
+    }
+
+    /**
+     * @brief Park a coroutine until a frame buffer of a display is free; safe from IRQ context.
+     *
+     * The executor becomes the display's free callback, so a display should
+     * be used by one executor only.
+     * @param display Display whose frame buffers are all in use.
+     * @param h The coroutine to resume; it then retries its submission.
+     */
+    void wait(TM1637 &display, std::coroutine_handle<> h)
+    {
+        uint32_t irq = save_and_disable_interrupts();
+        display.set_free_callback(_free, this);
+        waiting_[waiting_count_] = Waiter{&display, h};
+        ++waiting_count_;
+        restore_interrupts(irq);
+    }
+
+    /**
+     * @brief Resume ready coroutines until every spawned task has finished.
+     */
+    void run()
+    {
+        while (live_)
+        {
+            std::coroutine_handle<> h;
+            uint32_t irq = save_and_disable_interrupts();
+            if (count_)
+            {
+                h = ready_[head_];
+                head_ = (head_ + 1) % N;
+                --count_;
+            }
+            restore_interrupts(irq);
+            if (h)
+                h.resume();
+            else
+                tight_loop_contents();
+        }
+    }
+
+    /**
+     * @brief Awaitable that requeues the current coroutine behind the others.
+     * @return The awaitable.
+     */
+    auto yield()
+    {
+        struct Yield
+        {
+            TM1637Executor &executor;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { executor.post(h); }
+            void await_resume() const noexcept {}
+        };
+        return Yield{*this};
+    }
+
+private:
+    friend struct TM1637Task::promise_type::FinalAwaiter;
+
+    /**
+     * @brief A coroutine parked by wait().
+     */
+    struct Waiter
+    {
+        TM1637 *display;                ///< Display it waits for.
+        std::coroutine_handle<> handle; ///< The coroutine.
+    };
+
+    /**
+     * @brief Free callback: make the oldest coroutine waiting for the display ready.
+     * @param display Display that freed a frame buffer.
+     * @param user The executor.
+     */
+    static void _free(TM1637 &display, void *user)
+    {
+        TM1637Executor *self = static_cast<TM1637Executor *>(user);
+        for (size_t i = 0; i < self->waiting_count_; ++i)
+        {
+            if (self->waiting_[i].display == &display)
+            {
+                std::coroutine_handle<> h = self->waiting_[i].handle;
+                for (size_t j = i + 1; j < self->waiting_count_; ++j)
+                    self->waiting_[j - 1] = self->waiting_[j];
+                --self->waiting_count_;
+                self->post(h);
+                return;
+            }
+        }
+    }
+
+    std::coroutine_handle<> ready_[N]; ///< Ring buffer of coroutines ready to run.
+    size_t head_ = 0;                  ///< Index of the oldest ready coroutine.
+    size_t count_ = 0;                 ///< Number of ready coroutines.
+    size_t live_ = 0;                  ///< Spawned tasks not finished yet.
+    Waiter waiting_[N];                ///< Coroutines waiting for a frame buffer, oldest first.
+    size_t waiting_count_ = 0;         ///< Number of waiting coroutines.
+};
+
+inline std::coroutine_handle<> TM1637Task::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> h) noexcept
+{
+    promise_type &p = h.promise();
+    if (p.continuation)
+        return p.continuation;
+    if (p.executor)
+    {
+        --p.executor->live_;
+        h.destroy();
+    }
+    return std::noop_coroutine();
+}
+
+/**
+ * @class TM1637Submit
+ * @brief Awaitable submitting one DMA frame; resumes once the frame is in the PIO TX FIFO.
+ *
+ * await_resume() returns false when the frame could not be submitted and
+ * the coroutine should try again. If both frame buffers were in use it was
+ * parked until one became free; otherwise (the bus held by the other core)
+ * it was only requeued.
+ */
+class TM1637Submit
+{
+public:
+    /**
+     * @brief Awaitable for a segment frame.
+     * @param executor Executor resuming the coroutine.
+     * @param display PIO driven display.
+     * @param segments Array of 7-segment LED segments, 3 or 6.
+     * @param pos Starting position on the display (0-5).
+     */
+    TM1637Submit(TM1637Executor &executor, TM1637 &display, const Segments &segments, uint8_t pos)
+        : executor_(executor), display_(display), segments_(&segments), pos_(pos), brightness_(0) {}
+
+    /**
+     * @brief Awaitable for a brightness change.
+     * @param executor Executor resuming the coroutine.
+     * @param display PIO driven display.
+     * @param val Brightness level (0-7).
+     */
+    TM1637Submit(TM1637Executor &executor, TM1637 &display, uint8_t val)
+        : executor_(executor), display_(display), segments_(nullptr), pos_(0), brightness_(val) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        handle_ = h;
+        // a buffer freed between the failed submission and wait() would be missed
+        uint32_t irq = save_and_disable_interrupts();
+        submitted_ = segments_ ? display_.submit(*segments_, pos_, _done, this)
+                               : display_.submit_brightness(brightness_, _done, this);
+        if (!submitted_)
+        {
+            if (display_.busy())
+                executor_.wait(display_, h);
+            else
+                executor_.post(h);
+        }
+        restore_interrupts(irq);
+    }
+    bool await_resume() const noexcept { return submitted_; }
+
+private:
+    static void _done(TM1637 &, void *user)
+    {
+        TM1637Submit *self = static_cast<TM1637Submit *>(user);
+        self->executor_.post(self->handle_);
+    }
+
+    TM1637Executor &executor_;
+    TM1637 &display_;
+    const Segments *segments_;
+    uint8_t pos_;
+    uint8_t brightness_;
+    bool submitted_ = false;
+    std::coroutine_handle<> handle_;
+};
+
+/**
+ * @brief Awaitable write(): suspends until the frame is in the PIO TX FIFO.
+ * @param executor Executor resuming the coroutine.
+ * @param display PIO driven display.
+ * @param segments Array of 7-segment LED segments, 3 or 6; other counts are not sent.
+ * @param pos Starting position on the display (0-5).
+ * @return Task to co_await.
+ */
+inline TM1637Task write_async(TM1637Executor &executor, TM1637 &display, Segments segments, uint8_t pos = 0)
+{
+    // submit() would refuse the frame on every retry
+    if (segments.empty() || !TM1637Chip::fits(segments.size()))
+        co_return;
+    // retry after every wake-up; kept out of the loop condition,
+    // which some GCC releases miscompile when it contains co_await
+    bool submitted = false;
+    while (!submitted)
+        submitted = co_await TM1637Submit(executor, display, segments, pos);
+}
+
+/**
+ * @brief Awaitable show(): encodes the string and suspends until the frame is in the PIO TX FIFO.
+ * @param executor Executor resuming the coroutine.
+ * @param display PIO driven display.
+ * @param str The input string.
+ * @return Task to co_await.
+ */
+inline TM1637Task show_async(TM1637Executor &executor, TM1637 &display, std::string str)
+{
+    co_await write_async(executor, display, display.encode_string(str));
+}
+
+/**
+ * @brief Awaitable brightness(): suspends until the control command is in the PIO TX FIFO.
+ * @param executor Executor resuming the coroutine.
+ * @param display PIO driven display.
+ * @param val Brightness level (0-7).
+ * @return Task to co_await.
+ */
+inline TM1637Task brightness_async(TM1637Executor &executor, TM1637 &display, uint8_t val)
+{
+    // retry after every wake-up; kept out of the loop condition,
+    // which some GCC releases miscompile when it contains co_await
+    bool submitted = false;
+    while (!submitted)
+        submitted = co_await TM1637Submit(executor, display, val);
+}
+
+#endif // TM1637_CORO_HPP
@@ -0,0 +1,85 @@
+/**
+ * @file tm1637_frame.hpp
+ * @brief Protocol constants and compile-time frame builder for the TM1637.
+ */
+
+#ifndef TM1637_FRAME_HPP
+#define TM1637_FRAME_HPP
+
+#include "tm16xx.hpp"
+
+/**
+ * @brief TM1637 command for sending data to the display.
+ */
+constexpr uint8_t TM1637_CMD1 = TM16XX_CMD_DATA;
+
+/**
+ * @brief TM1637 data command flag selecting key-scan read instead of display write.
+ */
+constexpr uint8_t TM1637_READ_KEYS = 0x02;
+
+/**
+ * @brief TM1637 data command flag selecting fixed address mode (no auto increment).
+ */
+constexpr uint8_t TM1637_FIXED_ADDR = 0x04;
+
+/**
+ * @brief TM1637 command for addressing a specific digit on the display.
+ */
+constexpr uint8_t TM1637_CMD2 = TM16XX_CMD_ADDR;
+
+/**
+ * @brief TM1637 command for controlling the display.
+ */
+constexpr uint8_t TM1637_CMD3 = TM16XX_CMD_CTRL;
+
+/**
+ * @brief TM1637 display control command for turning on the display.
+ */
+constexpr uint8_t TM1637_DSP_ON = TM16XX_DSP_ON;
+
+/**
+ * @brief Most significant bit (MSB) indicating the decimal point or colon on the display.
+ */
+constexpr uint8_t TM1637_MSB = TM16XX_DP;
+
+/**
+ * @typedef TM1637Frame
+ * @brief Precompiled transaction stream for one TM1637 frame, send it with TM1637::write_raw().
+ * @tparam N Number of digits in the frame.
+ */
+template <size_t N>
+using TM1637Frame = TM16xxFrame<TM1637Chip, N>;
+
+/**
+ * @brief Build the transaction stream for a frame of pre-encoded segments at compile time.
+ * @param segments Array of 7-segment LED segments, 3 or 6 of them.
+ * @param brightness Brightness level for the display (0-7).
+ * @param pos Starting position on the display (0-5).
+ * @return The precompiled frame.
+ */
+template <size_t N>
+constexpr TM1637Frame<N> tm1637_frame(const uint8_t (&segments)[N], uint8_t brightness = 7, uint8_t pos = 0)
+{
+    return tm16xx_frame<TM1637Chip>(segments, brightness, pos);
+}
+
+/**
+ * @brief Build the transaction stream for a text frame at compile time.
+ *
+ * The text is encoded like TM1637::show(): '.' sets the decimal point of the
+ * preceding digit and the result is padded with blanks to 6 digits. Digits
+ * beyond the sixth are dropped.
+ * @param str The input string literal.
+ * @param brightness Brightness level for the display (0-7).
+ * @param font Font to render the text with.
+ * @return The precompiled frame.
+ */
+template <size_t L>
+constexpr TM1637Frame<6> tm1637_frame(const char (&str)[L], uint8_t brightness = 7,
+                                      const TM16xxFont &font = TM16XX_FONT)
+{
+    return tm16xx_frame<TM1637Chip>(str, brightness, font);
+}
+
+#endif // TM1637_FRAME_HPP
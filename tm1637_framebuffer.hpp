@@ -0,0 +1,32 @@
+/**
+ * @file tm1637_framebuffer.hpp
+ * @brief TM1637 names for the segment-level framebuffer of tm16xx.hpp.
+ */
+
+#ifndef TM1637_FRAMEBUFFER_HPP
+#define TM1637_FRAMEBUFFER_HPP
+
+#include "tm1637.hpp"
+
+/**
+ * @typedef TM1637Segment
+ * @brief Segment indices within a digit.
+ */
+typedef TM16xxSegment TM1637Segment;
+
+constexpr TM1637Segment TM1637_SEG_A = TM16XX_SEG_A;   ///< Top.
+constexpr TM1637Segment TM1637_SEG_B = TM16XX_SEG_B;   ///< Top right.
+constexpr TM1637Segment TM1637_SEG_C = TM16XX_SEG_C;   ///< Bottom right.
+constexpr TM1637Segment TM1637_SEG_D = TM16XX_SEG_D;   ///< Bottom.
+constexpr TM1637Segment TM1637_SEG_E = TM16XX_SEG_E;   ///< Bottom left.
+constexpr TM1637Segment TM1637_SEG_F = TM16XX_SEG_F;   ///< Top left.
+constexpr TM1637Segment TM1637_SEG_G = TM16XX_SEG_G;   ///< Middle.
+constexpr TM1637Segment TM1637_SEG_DP = TM16XX_SEG_DP; ///< Decimal point.
+
+/**
+ * @typedef TM1637Framebuffer
+ * @brief Off-screen copy of the six digits of a TM1637 display, sent to it in one flush.
+ */
+typedef TM16xxFramebuffer<TM1637Chip, TM1637> TM1637Framebuffer;
+
+#endif // TM1637_FRAMEBUFFER_HPP
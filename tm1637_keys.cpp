@@ -0,0 +1,108 @@
+/**
+ * @file tm1637_keys.cpp
+ * @brief Implementation of the TM1637Keypad class debouncing TM1637 key-scan codes.
+ */
+#include "tm1637_keys.hpp"
+
+/**
+ * @brief Constructor for the TM1637Keypad class.
+ * @param debounce_us Time a code has to stay stable before it is accepted.
+ * @param repeat_delay_us Hold time before the first repeat event, 0 disables repeat.
+ * @param repeat_interval_us Time between repeat events.
+ */
+TM1637Keypad::TM1637Keypad(uint32_t debounce_us, uint32_t repeat_delay_us, uint32_t repeat_interval_us)
+    : debounce_us_(debounce_us), repeat_delay_us_(repeat_delay_us), repeat_interval_us_(repeat_interval_us),
+      candidate_(-1), candidate_since_(0), stable_(-1), next_repeat_(0),
+      events_(), head_(0), count_(0), dropped_(0)
+{
+}
+
+/**
+ * @brief Feed one key-scan result into the debouncer.
+ * @param code Raw code returned by TM1637::read_key().
+ * @param now_us Time of the scan in microseconds.
+ */
+void TM1637Keypad::update(uint8_t code, uint64_t now_us)
+{
+    int8_t key = decode(code);
+    if (key != candidate_)
+    {
+        candidate_ = key;
+        candidate_since_ = now_us;
+        return;
+    }
+    if (now_us - candidate_since_ < debounce_us_)
+        return;
+
+    if (key != stable_)
+    {
+        if (stable_ >= 0)
+            _push(stable_, TM1637_KEY_RELEASE, now_us);
+        stable_ = key;
+        if (stable_ >= 0)
+            _push(stable_, TM1637_KEY_PRESS, now_us);
+        next_repeat_ = now_us + repeat_delay_us_;
+    }
+    else if ((stable_ >= 0) && repeat_delay_us_ && (now_us >= next_repeat_))
+    {
+        _push(stable_, TM1637_KEY_REPEAT, now_us);
+        next_repeat_ = now_us + repeat_interval_us_;
+    }
+}
+
+/**
+ * @brief Take the oldest pending event.
+ * @param event Receives the event.
+ * @return false if no event is pending.
+ */
+bool TM1637Keypad::next(TM1637KeyEvent &event)
+{
+    if (!count_)
+        return false;
+    event = events_[head_];
+    head_ = (head_ + 1) % QUEUE_SIZE;
+    --count_;
+    return true;
+}
+
+/**
+ * @brief Number of events lost because the queue was full.
+ * @return The count since construction.
+ */
+uint32_t TM1637Keypad::dropped() const
+{
+    return dropped_;
+}
+
+/**
+ * @brief Translate a raw key-scan code into a key index.
+ * @param code Raw code returned by TM1637::read_key().
+ * @return Key index 0-15, or -1 if no key is pressed.
+ */
+int8_t TM1637Keypad::decode(uint8_t code)
+{
+    // K1 rows read 0xF7 (SG1) down to 0xF0 (SG8), K2 rows 0xEF down to 0xE8,
+    // anything else (0xFF when idle) means no key.
+    if ((code & 0xF8) == 0xF0)
+        return int8_t(7 - (code & 0x07));
+    if ((code & 0xF8) == 0xE8)
+        return int8_t(15 - (code & 0x07));
+    return -1;
+}
+
+/**
+ * @brief Private method to append an event, dropping it if the queue is full.
+ */
+void TM1637Keypad::_push(uint8_t key, TM1637KeyAction action, uint64_t now_us)
+{
+    if (count_ == QUEUE_SIZE)
+    {
+        ++dropped_;
+        return;
+    }
+    TM1637KeyEvent &event = events_[(head_ + count_) % QUEUE_SIZE];
+    event.key = key;
+    event.action = action;
+    event.time_us = now_us;
+    ++count_;
+}
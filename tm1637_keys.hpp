@@ -0,0 +1,101 @@
+/**
+ * @file tm1637_keys.hpp
+ * @brief Header file for the TM1637Keypad class debouncing TM1637 key-scan codes.
+ */
+
+#ifndef TM1637_KEYS_HPP
+#define TM1637_KEYS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @enum TM1637KeyAction
+ * @brief Kind of key event.
+ */
+enum TM1637KeyAction
+{
+    TM1637_KEY_PRESS,   ///< Key went down.
+    TM1637_KEY_RELEASE, ///< Key went up.
+    TM1637_KEY_REPEAT   ///< Key is held, auto-repeat tick.
+};
+
+/**
+ * @struct TM1637KeyEvent
+ * @brief Debounced key event.
+ */
+struct TM1637KeyEvent
+{
+    uint8_t key;            ///< Key index 0-15: K1 with SG1-SG8 is 0-7, K2 with SG1-SG8 is 8-15.
+    TM1637KeyAction action; ///< What happened.
+    uint64_t time_us;       ///< Time of the scan that produced the event.
+};
+
+/**
+ * @class TM1637Keypad
+ * @brief Debouncer and event queue for the key-scan codes read by TM1637::read_key().
+ *
+ * The chip reports at most one key at a time. A new code has to be seen for
+ * the debounce time before it is accepted; a held key produces repeat events
+ * after the repeat delay.
+ */
+class TM1637Keypad
+{
+public:
+    static const size_t QUEUE_SIZE = 8; ///< Events kept until read with next().
+
+    /**
+     * @brief Constructor for the TM1637Keypad class.
+     * @param debounce_us Time a code has to stay stable before it is accepted.
+     * @param repeat_delay_us Hold time before the first repeat event, 0 disables repeat.
+     * @param repeat_interval_us Time between repeat events.
+     */
+    TM1637Keypad(uint32_t debounce_us = 20000, uint32_t repeat_delay_us = 500000, uint32_t repeat_interval_us = 100000);
+
+    /**
+     * @brief Feed one key-scan result into the debouncer.
+     * @param code Raw code returned by TM1637::read_key().
+     * @param now_us Time of the scan in microseconds.
+     */
+    void update(uint8_t code, uint64_t now_us);
+
+    /**
+     * @brief Take the oldest pending event.
+     * @param event Receives the event.
+     * @return false if no event is pending.
+     */
+    bool next(TM1637KeyEvent &event);
+
+    /**
+     * @brief Number of events lost because the queue was full.
+     * @return The count since construction.
+     */
+    uint32_t dropped() const;
+
+    /**
+     * @brief Translate a raw key-scan code into a key index.
+     * @param code Raw code returned by TM1637::read_key().
+     * @return Key index 0-15, or -1 if no key is pressed.
+     */
+    static int8_t decode(uint8_t code);
+
+private:
+    /**
+     * @brief Private method to append an event, dropping it if the queue is full.
+     */
+    void _push(uint8_t key, TM1637KeyAction action, uint64_t now_us);
+
+    uint32_t debounce_us_;        ///< Required stable time of a new code.
+    uint32_t repeat_delay_us_;    ///< Hold time before the first repeat.
+    uint32_t repeat_interval_us_; ///< Time between repeats.
+    int8_t candidate_;            ///< Last decoded key, -1 for none.
+    uint64_t candidate_since_;    ///< Time the candidate was first seen.
+    int8_t stable_;               ///< Debounced key, -1 for none.
+    uint64_t next_repeat_;        ///< Time of the next repeat event.
+    TM1637KeyEvent events_[QUEUE_SIZE]; ///< Ring buffer of pending events.
+    size_t head_;                 ///< Index of the oldest pending event.
+    size_t count_;                ///< Number of pending events.
+    uint32_t dropped_;            ///< Events lost to a full queue.
+};
+
+#endif // TM1637_KEYS_HPP
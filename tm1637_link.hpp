@@ -0,0 +1,115 @@
+/**
+ * @file tm1637_link.hpp
+ * @brief Binary frame protocol for driving TM1637 displays from a host over stdio/USB CDC.
+ *
+ * A frame carries pre-encoded segments for one display, so the firmware
+ * only validates and routes it. Layout:
+ *
+ *     0      TM1637_LINK_SYNC
+ *     1      display id (TM1637Manager id)
+ *     2      attributes: bits 0-2 brightness, bit 3 TM1637_LINK_BRIGHTNESS,
+ *            bits 4-5 priority
+ *     3      start position << 4 | segment count (0-6)
+ *     4..    segments, in display order
+ *     last   checksum: one's complement of the sum of bytes 1 to last - 1
+ *
+ * This header does not depend on the Pico SDK; the host side includes it to
+ * build frames with the same segment encoding as the driver.
+ */
+
+#ifndef TM1637_LINK_HPP
+#define TM1637_LINK_HPP
+
+#include "tm16xx.hpp"
+
+/**
+ * @brief First byte of every frame; the receiver resynchronises on it.
+ */
+constexpr uint8_t TM1637_LINK_SYNC = 0xA5;
+
+/**
+ * @brief Attribute flag: apply the brightness in bits 0-2.
+ */
+constexpr uint8_t TM1637_LINK_BRIGHTNESS = 0x08;
+
+/**
+ * @brief Bytes of a frame around the segments (sync, id, attributes, position/count, checksum).
+ */
+constexpr size_t TM1637_LINK_OVERHEAD = 5;
+
+/**
+ * @brief Largest frame, carrying all six digits.
+ */
+constexpr size_t TM1637_LINK_MAX_FRAME = TM1637_LINK_OVERHEAD + TM1637Chip::GRIDS;
+
+/**
+ * @brief Build the attribute byte of a frame.
+ * @param priority TM1637Manager priority level (0-3).
+ * @param brightness Brightness level (0-7), or -1 to leave the brightness unchanged.
+ * @return The attribute byte.
+ */
+constexpr uint8_t tm1637_link_attributes(uint8_t priority = 0, int brightness = -1)
+{
+    return uint8_t(((priority & 0x03) << 4) |
+                   (brightness < 0 ? 0 : TM1637_LINK_BRIGHTNESS | (brightness & 0x07)));
+}
+
+/**
+ * @brief Checksum over the bytes following the sync byte.
+ * @param data First byte after TM1637_LINK_SYNC.
+ * @param len Number of bytes covered.
+ * @return One's complement of their sum.
+ */
+constexpr uint8_t tm1637_link_checksum(const uint8_t *data, size_t len)
+{
+    uint8_t sum = 0;
+    for (size_t i = 0; i < len; ++i)
+        sum = uint8_t(sum + data[i]);
+    return uint8_t(~sum);
+}
+
+/**
+ * @brief Encode a frame of pre-encoded segments.
+ * @param out Buffer of at least TM1637_LINK_MAX_FRAME bytes.
+ * @param id Display id.
+ * @param segments Segments in display order.
+ * @param count Number of segments, clipped to the grids left after pos.
+ * @param pos Starting position on the display (0-5).
+ * @param attributes Attribute byte from tm1637_link_attributes().
+ * @return Length of the frame in bytes.
+ */
+constexpr size_t tm1637_link_encode(uint8_t *out, uint8_t id, const uint8_t *segments, size_t count,
+                                    uint8_t pos = 0, uint8_t attributes = 0)
+{
+    if (pos >= TM1637Chip::GRIDS)
+        pos = TM1637Chip::GRIDS - 1;
+    if (count > TM1637Chip::GRIDS - pos)
+        count = TM1637Chip::GRIDS - pos;
+    out[0] = TM1637_LINK_SYNC;
+    out[1] = id;
+    out[2] = attributes;
+    out[3] = uint8_t((pos << 4) | count);
+    for (size_t i = 0; i < count; ++i)
+        out[4 + i] = segments[i];
+    out[4 + count] = tm1637_link_checksum(out + 1, 3 + count);
+    return TM1637_LINK_OVERHEAD + count;
+}
+
+/**
+ * @brief Encode a frame showing a string, rendered like TM1637::show().
+ * @param out Buffer of at least TM1637_LINK_MAX_FRAME bytes.
+ * @param id Display id.
+ * @param str The input string; a '.' lights the decimal point of the digit before it.
+ * @param len Length of the string.
+ * @param attributes Attribute byte from tm1637_link_attributes().
+ * @return Length of the frame in bytes.
+ */
+constexpr size_t tm1637_link_encode_text(uint8_t *out, uint8_t id, const char *str, size_t len,
+                                         uint8_t attributes = 0)
+{
+    uint8_t segments[TM1637Chip::GRIDS] = {};
+    tm16xx_encode_text<TM1637Chip>(str, len, segments);
+    return tm1637_link_encode(out, id, segments, TM1637Chip::GRIDS, 0, attributes);
+}
+
+#endif // TM1637_LINK_HPP
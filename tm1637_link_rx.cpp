@@ -0,0 +1,163 @@
+/**
+ * @file tm1637_link_rx.cpp
+ * @brief Implementation of the TM1637LinkReceiver class routing host frames to a TM1637Manager.
+ */
+#include "tm1637_link_rx.hpp"
+
+#include <pico/stdlib.h>
+
+/**
+ * @brief Constructor for the TM1637LinkReceiver class.
+ * @param manager Manager whose display ids the frames address.
+ */
+TM1637LinkReceiver::TM1637LinkReceiver(TM1637Manager &manager)
+    : manager_(manager), frame_(), len_(0), need_(0), content_(), brightness_(), stats_()
+{
+    for (size_t i = 0; i < TM1637Manager::MAX_DISPLAYS; ++i)
+        brightness_[i] = 0xFF;
+}
+
+/**
+ * @brief Read the bytes available on stdio and parse them.
+ * @param max_bytes Maximum number of bytes read in this call.
+ * @return Number of frames completed.
+ */
+size_t TM1637LinkReceiver::poll(size_t max_bytes)
+{
+    uint8_t buf[64];
+    size_t frames = 0;
+    while (max_bytes)
+    {
+        // drain what the stdio driver has buffered, then parse it in one go
+        size_t n = 0;
+        while ((n < sizeof(buf)) && (n < max_bytes))
+        {
+            int c = getchar_timeout_us(0);
+            if (c < 0)
+                break;
+            buf[n++] = uint8_t(c);
+        }
+        if (!n)
+            break;
+        max_bytes -= n;
+        frames += feed(buf, n);
+    }
+    return frames;
+}
+
+/**
+ * @brief Parse bytes received by other means.
+ * @param data The received bytes.
+ * @param len Number of bytes.
+ * @return Number of frames completed.
+ */
+size_t TM1637LinkReceiver::feed(const uint8_t *data, size_t len)
+{
+    size_t frames = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        uint8_t b = data[i];
+        if (!len_)
+        {
+            if (b == TM1637_LINK_SYNC)
+            {
+                frame_[len_++] = b;
+                need_ = TM1637_LINK_OVERHEAD;
+            }
+            else
+                ++stats_.skipped;
+            continue;
+        }
+
+        frame_[len_++] = b;
+        if (len_ == 4)
+        {
+            // the position/count byte fixes the frame length
+            size_t count = b & 0x0F;
+            if (count > TM1637Chip::GRIDS)
+            {
+                ++stats_.errors;
+                frames += _resync();
+                continue;
+            }
+            need_ = TM1637_LINK_OVERHEAD + count;
+        }
+        if (len_ == need_)
+        {
+            if (tm1637_link_checksum(frame_ + 1, need_ - 2) != frame_[need_ - 1])
+            {
+                ++stats_.errors;
+                frames += _resync();
+                continue;
+            }
+            if (_dispatch())
+                ++frames;
+            len_ = 0;
+        }
+    }
+    return frames;
+}
+
+/**
+ * @brief Get the receive statistics.
+ * @return The statistics.
+ */
+const TM1637LinkStats &TM1637LinkReceiver::stats() const
+{
+    return stats_;
+}
+
+/**
+ * @brief Private method to drop a partial frame that failed its count or checksum and re-parse the bytes after its sync byte.
+ * @return Number of frames completed from those bytes.
+ */
+size_t TM1637LinkReceiver::_resync()
+{
+    // the sync byte may have been noise, and the next real frame can start
+    // among the bytes taken for this one
+    uint8_t rest[TM1637_LINK_MAX_FRAME];
+    size_t n = len_ - 1;
+    for (size_t i = 0; i < n; ++i)
+        rest[i] = frame_[1 + i];
+    len_ = 0;
+    return feed(rest, n);
+}
+
+/**
+ * @brief Private method to route a complete frame whose checksum matched.
+ * @return true if the frame addressed a known display and fits its digits.
+ */
+bool TM1637LinkReceiver::_dispatch()
+{
+    uint8_t id = frame_[1];
+    uint8_t attributes = frame_[2];
+    uint8_t pos = frame_[3] >> 4;
+    size_t count = frame_[3] & 0x0F;
+    if (!manager_.display(id) || (pos + count > TM1637Chip::GRIDS))
+    {
+        ++stats_.errors;
+        return false;
+    }
+
+    uint8_t priority = (attributes >> 4) & 0x03;
+    if (attributes & TM1637_LINK_BRIGHTNESS)
+    {
+        // queued like the digits, poll() itself never touches the bus
+        uint8_t val = attributes & 0x07;
+        if (val != brightness_[id])
+        {
+            brightness_[id] = val;
+            manager_.post_brightness(id, val, priority);
+        }
+    }
+    if (count)
+    {
+        // write() takes whole frames, the chip's digit order is not contiguous
+        uint8_t *content = content_[id];
+        for (size_t i = 0; i < count; ++i)
+            content[pos + i] = frame_[4 + i];
+        manager_.post(id, Segments(content, content + TM1637Chip::GRIDS), priority);
+    }
+    ++stats_.frames;
+    return true;
+}
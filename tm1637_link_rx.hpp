@@ -0,0 +1,90 @@
+/**
+ * @file tm1637_link_rx.hpp
+ * @brief Header file for the TM1637LinkReceiver class routing host frames to a TM1637Manager.
+ */
+
+#ifndef TM1637_LINK_RX_HPP
+#define TM1637_LINK_RX_HPP
+
+#include "tm1637_link.hpp"
+#include "tm1637_manager.hpp"
+
+/**
+ * @struct TM1637LinkStats
+ * @brief Receive statistics kept by TM1637LinkReceiver.
+ */
+struct TM1637LinkStats
+{
+    uint32_t frames;    ///< Valid frames routed to the manager.
+    uint32_t errors;    ///< Frames dropped for a bad checksum, length or display id.
+    uint32_t skipped;   ///< Bytes discarded while looking for TM1637_LINK_SYNC.
+};
+
+/**
+ * @class TM1637LinkReceiver
+ * @brief Parses tm1637_link.hpp frames and posts them to a TM1637Manager.
+ *
+ * Bytes are drained from stdio (USB CDC or UART) in batches without
+ * blocking, and parsed by a small state machine that keeps partial frames
+ * across calls. A frame with a bad count or checksum is dropped and the
+ * bytes after its sync byte are scanned again, so a sync value in line
+ * noise does not swallow the frame behind it. The digits of a frame are
+ * merged into the content kept for its display, which is posted whole with
+ * the frame's priority; a brightness attribute that differs from the last
+ * one received is queued with TM1637Manager::post_brightness(). Only
+ * service() touches the bus, so call poll() and TM1637Manager::service()
+ * from the main loop.
+ */
+class TM1637LinkReceiver
+{
+public:
+    /**
+     * @brief Constructor for the TM1637LinkReceiver class.
+     * @param manager Manager whose display ids the frames address.
+     */
+    explicit TM1637LinkReceiver(TM1637Manager &manager);
+
+    /**
+     * @brief Read the bytes available on stdio and parse them.
+     * @param max_bytes Maximum number of bytes read in this call.
+     * @return Number of frames completed.
+     */
+    size_t poll(size_t max_bytes = 64);
+
+    /**
+     * @brief Parse bytes received by other means.
+     * @param data The received bytes.
+     * @param len Number of bytes.
+     * @return Number of frames completed.
+     */
+    size_t feed(const uint8_t *data, size_t len);
+
+    /**
+     * @brief Get the receive statistics.
+     * @return The statistics.
+     */
+    const TM1637LinkStats &stats() const;
+
+private:
+    /**
+     * @brief Private method to drop a partial frame that failed its count or checksum and re-parse the bytes after its sync byte.
+     * @return Number of frames completed from those bytes.
+     */
+    size_t _resync();
+
+    /**
+     * @brief Private method to route a complete frame whose checksum matched.
+     * @return true if the frame addressed a known display and fits its digits.
+     */
+    bool _dispatch();
+
+    TM1637Manager &manager_;               ///< Destination of the frames.
+    uint8_t frame_[TM1637_LINK_MAX_FRAME]; ///< Frame being received.
+    size_t len_;                           ///< Bytes of frame_ received so far, 0 while hunting for sync.
+    size_t need_;                          ///< Total length of the frame being received.
+    uint8_t content_[TM1637Manager::MAX_DISPLAYS][TM1637Chip::GRIDS]; ///< Digits received per display, in display order.
+    uint8_t brightness_[TM1637Manager::MAX_DISPLAYS]; ///< Last brightness queued per display, 0xFF if none.
+    TM1637LinkStats stats_;                ///< Receive statistics.
+};
+
+#endif // TM1637_LINK_RX_HPP
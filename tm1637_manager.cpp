@@ -0,0 +1,170 @@
+/**
+ * @file tm1637_manager.cpp
+ * @brief Implementation of the TM1637Manager class scheduling updates across several displays.
+ */
+#include "tm1637_manager.hpp"
+
+#include <pico/stdlib.h>
+#include <algorithm>
+
+/**
+ * @brief Constructor for the TM1637Manager class.
+ */
+TM1637Manager::TM1637Manager()
+    : slots_(), count_(0), next_()
+{
+}
+
+/**
+ * @brief Register a display; the manager keeps a reference, not a copy.
+ * @param display The display to schedule.
+ * @return Display id for post() and stats(), or -1 if MAX_DISPLAYS are registered.
+ */
+int TM1637Manager::add(TM1637 &display)
+{
+    if (count_ == MAX_DISPLAYS)
+        return -1;
+    slots_[count_].display = &display;
+    return int(count_++);
+}
+
+/**
+ * @brief Queue a frame for a display, replacing a pending one.
+ * @param id Display id returned by add().
+ * @param segments Array of 7-segment LED segments.
+ * @param priority Priority level (0 to PRIORITIES - 1); a replaced frame keeps the higher of the two.
+ * @param pos Starting position on the display (0-5).
+ * @return false for an unknown display id.
+ */
+bool TM1637Manager::post(int id, const Segments &segments, uint8_t priority, uint8_t pos)
+{
+    if ((id < 0) || (size_t(id) >= count_))
+        return false;
+    Slot &slot = slots_[id];
+    if (slot.pending)
+        ++slot.stats.coalesced;
+    slot.priority = _queue(slot, priority);
+    slot.segments = segments;
+    slot.pos = pos;
+    slot.pending = true;
+    return true;
+}
+
+/**
+ * @brief Queue a brightness change for a display, replacing a pending one.
+ * @param id Display id returned by add().
+ * @param val Brightness level (0-7).
+ * @param priority Priority level (0 to PRIORITIES - 1).
+ * @return false for an unknown display id.
+ */
+bool TM1637Manager::post_brightness(int id, uint8_t val, uint8_t priority)
+{
+    if ((id < 0) || (size_t(id) >= count_))
+        return false;
+    Slot &slot = slots_[id];
+    slot.priority = _queue(slot, priority);
+    slot.brightness = val & 0x07;
+    slot.brightness_pending = true;
+    return true;
+}
+
+/**
+ * @brief Send the next frame due, if any.
+ * @return true if a frame was sent.
+ */
+bool TM1637Manager::service()
+{
+    for (int prio = PRIORITIES - 1; prio >= 0; --prio)
+    {
+        for (size_t n = 0; n < count_; ++n)
+        {
+            size_t i = (next_[prio] + n) % count_;
+            Slot &slot = slots_[i];
+            if ((!slot.pending && !slot.brightness_pending) || (slot.priority != prio))
+                continue;
+
+            next_[prio] = (i + 1) % count_;
+            uint32_t latency = uint32_t(time_us_64() - slot.posted_us);
+            ++slot.stats.frames;
+            slot.stats.total_latency_us += latency;
+            if (latency > slot.stats.max_latency_us)
+                slot.stats.max_latency_us = latency;
+
+            if (slot.brightness_pending)
+            {
+                // first, so a pending frame is shown at the new level
+                slot.brightness_pending = false;
+                slot.display->brightness(slot.brightness);
+            }
+            if (slot.pending)
+            {
+                slot.pending = false;
+                slot.display->write(slot.segments, slot.pos);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Check whether any frame or brightness change is waiting.
+ * @return true if at least one display has a pending update.
+ */
+bool TM1637Manager::pending() const
+{
+    for (size_t i = 0; i < count_; ++i)
+        if (slots_[i].pending || slots_[i].brightness_pending)
+            return true;
+    return false;
+}
+
+/**
+ * @brief Get a registered display.
+ * @param id Display id returned by add().
+ * @return The display, or nullptr for an unknown id.
+ */
+TM1637 *TM1637Manager::display(int id) const
+{
+    if ((id < 0) || (size_t(id) >= count_))
+        return nullptr;
+    return slots_[id].display;
+}
+
+/**
+ * @brief Get the queueing statistics of a display.
+ * @param id Display id returned by add().
+ * @return The statistics, all zero for an unknown id.
+ */
+const TM1637QueueStats &TM1637Manager::stats(int id) const
+{
+    static const TM1637QueueStats none = {};
+    if ((id < 0) || (size_t(id) >= count_))
+        return none;
+    return slots_[id].stats;
+}
+
+/**
+ * @brief Reset the queueing statistics of all displays.
+ */
+void TM1637Manager::reset_stats()
+{
+    for (size_t i = 0; i < count_; ++i)
+        slots_[i].stats = TM1637QueueStats();
+}
+
+/**
+ * @brief Private method to mark a slot stale, keeping its post time and highest priority.
+ * @param slot The slot receiving an update.
+ * @param priority Priority of the update.
+ * @return The priority the slot is scheduled with.
+ */
+uint8_t TM1637Manager::_queue(Slot &slot, uint8_t priority)
+{
+    priority = std::min(priority, uint8_t(PRIORITIES - 1));
+    // a coalesced update keeps the most urgent priority it was posted with
+    if (slot.pending || slot.brightness_pending)
+        return std::max(priority, slot.priority);
+    slot.posted_us = time_us_64();
+    return priority;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file tm1637_manager.hpp
+ * @brief Header file for the TM1637Manager class scheduling updates across several displays.
+ */
+
+#ifndef TM1637_MANAGER_HPP
+#define TM1637_MANAGER_HPP
+
+#include "tm1637.hpp"
+
+/**
+ * @struct TM1637QueueStats
+ * @brief Per-display queueing statistics kept by TM1637Manager.
+ */
+struct TM1637QueueStats
+{
+    uint32_t frames;           ///< Frames sent, a brightness change counts as one.
+    uint32_t coalesced;        ///< Pending frames replaced by a newer post() before being sent.
+    uint32_t max_latency_us;   ///< Longest time from post() to the start of transmission (us).
+    uint64_t total_latency_us; ///< Sum of all latencies, divide by frames for the mean (us).
+};
+
+/**
+ * @class TM1637Manager
+ * @brief Schedules frame updates of several TM1637 displays by priority.
+ *
+ * Each display has one pending frame slot; posting again before it was sent
+ * replaces the content (the newest frame is the only one worth showing) but
+ * keeps the original post time and the highest priority posted, so latency
+ * is measured from when the display first went stale. service() sends
+ * exactly one frame, picking the highest pending priority and rotating
+ * round-robin among displays of equal priority, so a high-priority update
+ * waits at most for the frame already on the bus.
+ */
+class TM1637Manager
+{
+public:
+    static const size_t MAX_DISPLAYS = 16; ///< Maximum number of managed displays.
+    static const uint8_t PRIORITIES = 4;   ///< Priority levels, 0 is the lowest.
+
+    TM1637Manager();
+
+    /**
+     * @brief Register a display; the manager keeps a reference, not a copy.
+     * @param display The display to schedule.
+     * @return Display id for post() and stats(), or -1 if MAX_DISPLAYS are registered.
+     */
+    int add(TM1637 &display);
+
+    /**
+     * @brief Queue a frame for a display, replacing a pending one.
+     * @param id Display id returned by add().
+     * @param segments Array of 7-segment LED segments.
+     * @param priority Priority level (0 to PRIORITIES - 1); a replaced frame keeps the higher of the two.
+     * @param pos Starting position on the display (0-5).
+     * @return false for an unknown display id.
+     */
+    bool post(int id, const Segments &segments, uint8_t priority = 0, uint8_t pos = 0);
+
+    /**
+     * @brief Queue a brightness change for a display, replacing a pending one.
+     *
+     * It shares the display's slot with post(): service() applies the
+     * brightness before a pending frame, and the slot keeps the higher
+     * priority of the two.
+     * @param id Display id returned by add().
+     * @param val Brightness level (0-7).
+     * @param priority Priority level (0 to PRIORITIES - 1).
+     * @return false for an unknown display id.
+     */
+    bool post_brightness(int id, uint8_t val, uint8_t priority = 0);
+
+    /**
+     * @brief Send the next frame due, if any.
+     * @return true if a frame was sent.
+     */
+    bool service();
+
+    /**
+     * @brief Check whether any frame or brightness change is waiting.
+     * @return true if at least one display has a pending update.
+     */
+    bool pending() const;
+
+    /**
+     * @brief Get a registered display.
+     * @param id Display id returned by add().
+     * @return The display, or nullptr for an unknown id.
+     */
+    TM1637 *display(int id) const;
+
+    /**
+     * @brief Get the queueing statistics of a display.
+     * @param id Display id returned by add().
+     * @return The statistics, all zero for an unknown id.
+     */
+    const TM1637QueueStats &stats(int id) const;
+
+    /**
+     * @brief Reset the queueing statistics of all displays.
+     */
+    void reset_stats();
+
+private:
+    /**
+     * @brief Pending frame slot of one display.
+     */
+    struct Slot
+    {
+        TM1637 *display;         ///< Scheduled display.
+        Segments segments;       ///< Pending content.
+        uint8_t pos;             ///< Pending start position.
+        uint8_t priority;        ///< Priority of the pending update.
+        bool pending;            ///< A frame is waiting.
+        uint8_t brightness;      ///< Pending brightness level.
+        bool brightness_pending; ///< A brightness change is waiting.
+        uint64_t posted_us;      ///< Time the display first went stale.
+        TM1637QueueStats stats;  ///< Queueing statistics.
+    };
+
+    /**
+     * @brief Private method to mark a slot stale, keeping its post time and highest priority.
+     * @param slot The slot receiving an update.
+     * @param priority Priority of the update.
+     * @return The priority the slot is scheduled with.
+     */
+    uint8_t _queue(Slot &slot, uint8_t priority);
+
+    Slot slots_[MAX_DISPLAYS];   ///< One slot per registered display.
+    size_t count_;               ///< Number of registered displays.
+    size_t next_[PRIORITIES];    ///< Round-robin cursor per priority level.
+};
+
+#endif // TM1637_MANAGER_HPP
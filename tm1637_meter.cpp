@@ -0,0 +1,100 @@
+/**
+ * @file tm1637_meter.cpp
+ * @brief Implementation of the TM1637LevelMeter class rendering bar graphs with peak hold.
+ */
+#include "tm1637_meter.hpp"
+
+#include <pico/stdlib.h>
+#include <algorithm>
+
+/**
+ * @brief Segments of the three steps of a digit: e/f, g, b/c.
+ */
+static const uint8_t TM1637_METER_STEP[TM1637LevelMeter::STEPS_PER_DIGIT] = {0x30, 0x40, 0x06};
+
+/**
+ * @brief Constructor for the TM1637LevelMeter class.
+ * @param display The display to draw on; digits outside the meter stay blank.
+ * @param first First digit of the meter (0-5).
+ * @param digits Number of digits the meter spans.
+ */
+TM1637LevelMeter::TM1637LevelMeter(TM1637 &display, uint8_t first, uint8_t digits)
+    : display_(display), first_(std::min(first, uint8_t(TM1637Chip::GRIDS - 1))),
+      digits_(std::min(digits, uint8_t(TM1637Chip::GRIDS - first_))),
+      level_(0), peak_(0), hold_us_(1000000), decay_us_(100000), peak_us_(0), decaying_(false),
+      segments_()
+{
+}
+
+/**
+ * @brief Configure the peak indicator.
+ * @param hold_us Time the peak stays at its maximum, 0 disables the peak indicator.
+ * @param decay_us Time per step while the peak falls back.
+ */
+void TM1637LevelMeter::set_peak(uint32_t hold_us, uint32_t decay_us)
+{
+    hold_us_ = hold_us;
+    decay_us_ = decay_us;
+}
+
+/**
+ * @brief Show a new value.
+ * @param value The value, clipped to full_scale.
+ * @param full_scale Value that lights the whole meter.
+ * @return Number of digits sent.
+ */
+size_t TM1637LevelMeter::update(uint32_t value, uint32_t full_scale)
+{
+    uint32_t now = time_us_32();
+    value = std::min(value, full_scale);
+    level_ = full_scale ? uint8_t((uint64_t(value) * steps() + full_scale / 2) / full_scale) : 0;
+
+    if (level_ >= peak_)
+    {
+        peak_ = level_;
+        peak_us_ = now;
+        decaying_ = false;
+    }
+    else if (!decaying_ && (now - peak_us_ >= hold_us_))
+    {
+        decaying_ = true;
+        peak_us_ = now;
+    }
+    else if (decaying_ && (now - peak_us_ >= decay_us_))
+    {
+        // fall by the steps due since the last one, never below the bar
+        uint32_t fall = decay_us_ ? (now - peak_us_) / decay_us_ : peak_;
+        peak_ = uint8_t(std::max(int(level_), int(peak_) - int(std::min(fall, uint32_t(peak_)))));
+        peak_us_ += fall * decay_us_;
+    }
+
+    _render();
+    return display_.write_changed(segments_);
+}
+
+/**
+ * @brief Get the number of steps the meter resolves.
+ * @return digits * STEPS_PER_DIGIT.
+ */
+uint8_t TM1637LevelMeter::steps() const
+{
+    return uint8_t(digits_ * STEPS_PER_DIGIT);
+}
+
+/**
+ * @brief Private method to draw the bar and peak marker into segments_.
+ */
+void TM1637LevelMeter::_render()
+{
+    for (uint8_t d = 0; d < digits_; ++d)
+    {
+        uint8_t seg = 0;
+        for (uint8_t k = 0; k < STEPS_PER_DIGIT; ++k)
+        {
+            uint8_t step = uint8_t(d * STEPS_PER_DIGIT + k);
+            if ((step < level_) || (hold_us_ && (step + 1 == peak_)))
+                seg |= TM1637_METER_STEP[k];
+        }
+        segments_[first_ + d] = seg;
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * @file tm1637_meter.hpp
+ * @brief Header file for the TM1637LevelMeter class rendering bar graphs with peak hold.
+ */
+
+#ifndef TM1637_METER_HPP
+#define TM1637_METER_HPP
+
+#include "tm1637.hpp"
+
+/**
+ * @class TM1637LevelMeter
+ * @brief Horizontal level meter at segment resolution, with peak hold and decay.
+ *
+ * Each digit contributes three steps, left to right: the left vertical
+ * segments (e, f), the middle segment (g) and the right vertical segments
+ * (b, c), so six digits resolve 18 levels. The peak is marked by the single
+ * step it reached, held for a while and then lowered one step at a time
+ * until it meets the bar again. Only digits whose segments changed are
+ * sent (TM1637::write_changed()).
+ */
+class TM1637LevelMeter
+{
+public:
+    static const uint8_t STEPS_PER_DIGIT = 3; ///< Bar steps one digit can show.
+
+    /**
+     * @brief Constructor for the TM1637LevelMeter class.
+     * @param display The display to draw on; digits outside the meter stay blank.
+     * @param first First digit of the meter (0-5).
+     * @param digits Number of digits the meter spans.
+     */
+    TM1637LevelMeter(TM1637 &display, uint8_t first = 0, uint8_t digits = 6);
+
+    /**
+     * @brief Configure the peak indicator.
+     * @param hold_us Time the peak stays at its maximum, 0 disables the peak indicator.
+     * @param decay_us Time per step while the peak falls back.
+     */
+    void set_peak(uint32_t hold_us, uint32_t decay_us);
+
+    /**
+     * @brief Show a new value.
+     * @param value The value, clipped to full_scale.
+     * @param full_scale Value that lights the whole meter.
+     * @return Number of digits sent.
+     */
+    size_t update(uint32_t value, uint32_t full_scale);
+
+    /**
+     * @brief Get the number of steps the meter resolves.
+     * @return digits * STEPS_PER_DIGIT.
+     */
+    uint8_t steps() const;
+
+private:
+    /**
+     * @brief Private method to draw the bar and peak marker into segments_.
+     */
+    void _render();
+
+    TM1637 &display_;                    ///< Display the meter is drawn on.
+    uint8_t first_;                      ///< First digit of the meter.
+    uint8_t digits_;                     ///< Number of digits spanned.
+    uint8_t level_;                      ///< Steps lit by the bar.
+    uint8_t peak_;                       ///< Step count up to and including the peak marker.
+    uint32_t hold_us_;                   ///< Peak hold time, 0 without peak indicator.
+    uint32_t decay_us_;                  ///< Time per step of peak decay.
+    uint32_t peak_us_;                   ///< Time the peak was set or last lowered.
+    bool decaying_;                      ///< The hold time has passed.
+    uint8_t segments_[TM1637Chip::GRIDS]; ///< Rendered digits in display order.
+};
+
+#endif // TM1637_METER_HPP
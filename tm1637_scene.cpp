@@ -0,0 +1,116 @@
+/**
+ * @file tm1637_scene.cpp
+ * @brief Implementation of the TM1637ScenePlayer class.
+ */
+#include "tm1637_scene.hpp"
+#include "tm1637.hpp"
+
+#include <pico/stdlib.h>
+
+/**
+ * @brief Half period of a blinking page (us).
+ */
+const uint32_t TM1637_BLINK_US = 250000;
+
+/**
+ * @brief Transaction switching the display off, keeping its RAM.
+ */
+static const uint8_t TM1637_DISPLAY_OFF[] = {1, TM1637_CMD3};
+
+/**
+ * @brief Constructor for the TM1637ScenePlayer class.
+ * @param display The display to show the scene on.
+ */
+TM1637ScenePlayer::TM1637ScenePlayer(TM1637 &display)
+    : display_(display), pages_(nullptr), count_(0), index_(0), loop_(true), dark_(false),
+      shown_us_(0), blink_us_(0)
+{
+}
+
+/**
+ * @brief Start a scene at its first page.
+ * @param pages The pages, typically a constexpr array in flash.
+ * @param count Number of pages.
+ * @param loop Restart at the first page after the last one, otherwise hold the last page.
+ */
+void TM1637ScenePlayer::play(const TM1637Page *pages, size_t count, bool loop)
+{
+    pages_ = count ? pages : nullptr;
+    count_ = count;
+    loop_ = loop;
+    index_ = 0;
+    if (pages_)
+        _show();
+}
+
+/**
+ * @brief Advance pages and blink phases that are due.
+ * @return true if the display was written.
+ */
+bool TM1637ScenePlayer::update()
+{
+    if (!pages_)
+        return false;
+    const TM1637Page &page = pages_[index_];
+    uint32_t now = time_us_32();
+    if (page.duration_ms && (now - shown_us_ >= uint32_t(page.duration_ms) * 1000))
+    {
+        if ((index_ + 1 < count_) || loop_)
+        {
+            next();
+            return true;
+        }
+    }
+    if ((page.attributes & TM1637_PAGE_BLINK) && (now - blink_us_ >= TM1637_BLINK_US))
+    {
+        blink_us_ = now;
+        dark_ = !dark_;
+        // the display control transaction closes the page's stream
+        if (dark_)
+            display_.write_raw(TM1637_DISPLAY_OFF, sizeof(TM1637_DISPLAY_OFF));
+        else
+            display_.write_raw(page.frame.bytes + page.frame.size() - 2, 2);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Show the next page now.
+ */
+void TM1637ScenePlayer::next()
+{
+    select(index_ + 1 < count_ ? index_ + 1 : 0);
+}
+
+/**
+ * @brief Show a page now.
+ * @param index Page index, clipped to the last page.
+ */
+void TM1637ScenePlayer::select(size_t index)
+{
+    if (!pages_)
+        return;
+    index_ = index < count_ ? index : count_ - 1;
+    _show();
+}
+
+/**
+ * @brief Get the page being shown.
+ * @return The page index.
+ */
+size_t TM1637ScenePlayer::index() const
+{
+    return index_;
+}
+
+/**
+ * @brief Private method to send the current page and restart its timers.
+ */
+void TM1637ScenePlayer::_show()
+{
+    const TM1637Page &page = pages_[index_];
+    display_.write_raw(page.frame);
+    shown_us_ = blink_us_ = time_us_32();
+    dark_ = false;
+}
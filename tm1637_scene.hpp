@@ -0,0 +1,114 @@
+/**
+ * @file tm1637_scene.hpp
+ * @brief Flash-resident scene format and player for static TM1637 pages.
+ *
+ * A scene is a constant array of TM1637Page, each holding the precompiled
+ * transaction stream of one page plus its duration and attributes. Build
+ * pages with tm1637_page() in a constexpr array, or generate the array from
+ * a text description with tools/tm1637_scenegen.cpp; either way the data
+ * stays in flash and TM1637ScenePlayer sends it with write_raw() without
+ * parsing or allocating.
+ */
+
+#ifndef TM1637_SCENE_HPP
+#define TM1637_SCENE_HPP
+
+#include "tm1637_frame.hpp"
+
+/**
+ * @brief Page attribute: switch the display off and on twice a second while the page is shown.
+ */
+constexpr uint8_t TM1637_PAGE_BLINK = 0x01;
+
+/**
+ * @struct TM1637Page
+ * @brief One precompiled page of a scene.
+ */
+struct TM1637Page
+{
+    TM1637Frame<6> frame; ///< Transaction stream with all six digits and the display control.
+    uint16_t duration_ms; ///< Time the page is shown, 0 to hold it until next() or select().
+    uint8_t attributes;   ///< TM1637_PAGE_* flags.
+};
+
+/**
+ * @brief Build a page from text at compile time.
+ * @param str The input string literal, encoded like TM1637::show().
+ * @param brightness Brightness level for the display (0-7).
+ * @param duration_ms Time the page is shown, 0 to hold it.
+ * @param attributes TM1637_PAGE_* flags.
+ * @return The page.
+ */
+template <size_t L>
+constexpr TM1637Page tm1637_page(const char (&str)[L], uint8_t brightness = 7, uint16_t duration_ms = 0,
+                                 uint8_t attributes = 0)
+{
+    return TM1637Page{tm1637_frame(str, brightness), duration_ms, attributes};
+}
+
+class TM1637;
+
+/**
+ * @class TM1637ScenePlayer
+ * @brief Shows the pages of a scene on one display, advancing them by their durations.
+ *
+ * Call update() from the main loop; it only touches the bus when a page
+ * changes or a blinking page toggles.
+ */
+class TM1637ScenePlayer
+{
+public:
+    /**
+     * @brief Constructor for the TM1637ScenePlayer class.
+     * @param display The display to show the scene on.
+     */
+    explicit TM1637ScenePlayer(TM1637 &display);
+
+    /**
+     * @brief Start a scene at its first page.
+     * @param pages The pages, typically a constexpr array in flash.
+     * @param count Number of pages.
+     * @param loop Restart at the first page after the last one, otherwise hold the last page.
+     */
+    void play(const TM1637Page *pages, size_t count, bool loop = true);
+
+    /**
+     * @brief Advance pages and blink phases that are due.
+     * @return true if the display was written.
+     */
+    bool update();
+
+    /**
+     * @brief Show the next page now.
+     */
+    void next();
+
+    /**
+     * @brief Show a page now.
+     * @param index Page index, clipped to the last page.
+     */
+    void select(size_t index);
+
+    /**
+     * @brief Get the page being shown.
+     * @return The page index.
+     */
+    size_t index() const;
+
+private:
+    /**
+     * @brief Private method to send the current page and restart its timers.
+     */
+    void _show();
+
+    TM1637 &display_;          ///< Display the scene is shown on.
+    const TM1637Page *pages_;  ///< Pages of the scene, nullptr before play().
+    size_t count_;             ///< Number of pages.
+    size_t index_;             ///< Page being shown.
+    bool loop_;                ///< Restart after the last page.
+    bool dark_;                ///< A blinking page is in its off phase.
+    uint32_t shown_us_;        ///< Time the page was shown.
+    uint32_t blink_us_;        ///< Time of the last blink toggle.
+};
+
+#endif // TM1637_SCENE_HPP
@@ -0,0 +1,281 @@
+/**
+ * @file tm1637_timer.cpp
+ * @brief Implementation of the TM1637Timer class: countdown and stopwatch widgets driven by a hardware alarm.
+ */
+#include "tm1637_timer.hpp"
+
+#include <pico/stdlib.h>
+#include <hardware/sync.h>
+#include <algorithm>
+
+/**
+ * @brief Write a value as a fixed number of decimal digits.
+ * @param out Receives the digits.
+ * @param val The value.
+ * @param width Number of digits, leading zeros included.
+ * @return Pointer past the last digit.
+ */
+static char *_put_digits(char *out, uint32_t val, size_t width)
+{
+    for (size_t i = width; i-- > 0;)
+    {
+        out[i] = char('0' + val % 10);
+        val /= 10;
+    }
+    return out + width;
+}
+
+/**
+ * @brief Constructor for the TM1637Timer class.
+ * @param display The display to show the time on.
+ * @param format Time layout.
+ */
+TM1637Timer::TM1637Timer(TM1637 &display, TM1637TimerFormat format)
+    : display_(display), format_(format), period_us_(format == TM1637_TIMER_SSHH ? 10000 : 1000000),
+      countdown_(false), duration_us_(0), start_us_(0), elapsed_us_(0), next_us_(0), alarm_(0),
+      done_(nullptr), user_(nullptr), running_(false), expired_(false), due_(false), pending_()
+{
+}
+
+TM1637Timer::~TM1637Timer()
+{
+    if (alarm_)
+        cancel_alarm(alarm_);
+}
+
+/**
+ * @brief Start counting down.
+ * @param duration_ms Time until expiry (ms); 0 expires at once.
+ * @param done Optional callback run from the alarm IRQ at expiry, or before returning for a zero duration.
+ * @param user Opaque pointer passed to done.
+ * @return false if no hardware alarm is available.
+ */
+bool TM1637Timer::start_countdown(uint32_t duration_ms, TM1637TimerCallback done, void *user)
+{
+    stop();
+    countdown_ = true;
+    duration_us_ = uint64_t(duration_ms) * 1000;
+    elapsed_us_ = 0;
+    done_ = done;
+    user_ = user;
+    expired_ = false;
+    if (!duration_us_)
+    {
+        // nothing to count, expire without an alarm
+        uint32_t irq = save_and_disable_interrupts();
+        _render(0);
+        expired_ = true;
+        restore_interrupts(irq);
+        if (done_)
+            done_(*this, user_);
+        return true;
+    }
+    return _run();
+}
+
+/**
+ * @brief Start counting up from zero.
+ * @return false if no hardware alarm is available.
+ */
+bool TM1637Timer::start_stopwatch()
+{
+    stop();
+    countdown_ = false;
+    duration_us_ = 0;
+    elapsed_us_ = 0;
+    expired_ = false;
+    return _run();
+}
+
+/**
+ * @brief Pause, keeping the time shown.
+ */
+void TM1637Timer::stop()
+{
+    uint32_t irq = save_and_disable_interrupts();
+    if (alarm_)
+        cancel_alarm(alarm_);
+    alarm_ = 0;
+    if (running_)
+    {
+        elapsed_us_ = _elapsed(time_us_64());
+        running_ = false;
+        _render(elapsed_us_);
+    }
+    restore_interrupts(irq);
+}
+
+/**
+ * @brief Continue after stop(); an expired countdown stays at zero.
+ * @return false if no hardware alarm is available.
+ */
+bool TM1637Timer::resume()
+{
+    if (running_ || expired_)
+        return true;
+    return _run();
+}
+
+/**
+ * @brief Send the digits that changed since the last call.
+ * @return Number of digits sent.
+ */
+size_t TM1637Timer::update()
+{
+    if (!due_)
+        return 0;
+    uint8_t segments[TM1637Chip::GRIDS];
+    uint32_t irq = save_and_disable_interrupts();
+    std::copy(pending_, pending_ + sizeof(pending_), segments);
+    due_ = false;
+    restore_interrupts(irq);
+    return display_.write_changed(segments);
+}
+
+/**
+ * @brief Get the time a stopwatch has run, or a countdown has left.
+ * @return The time (ms).
+ */
+uint32_t TM1637Timer::time_ms() const
+{
+    uint64_t elapsed = _elapsed(time_us_64());
+    if (countdown_)
+        return uint32_t((duration_us_ - std::min(elapsed, duration_us_)) / 1000);
+    return uint32_t(elapsed / 1000);
+}
+
+/**
+ * @brief Check whether the timer is counting.
+ * @return true between start and stop or expiry.
+ */
+bool TM1637Timer::running() const
+{
+    return running_;
+}
+
+/**
+ * @brief Check whether a countdown has reached zero.
+ * @return true once expired.
+ */
+bool TM1637Timer::expired() const
+{
+    return expired_;
+}
+
+/**
+ * @brief Private method to arm the alarm for the next change of the shown value.
+ * @return false if no hardware alarm is available.
+ */
+bool TM1637Timer::_run()
+{
+    uint64_t now = time_us_64();
+    start_us_ = now - elapsed_us_;
+
+    // the shown value changes where the elapsed time is congruent to the
+    // countdown length (0 for a stopwatch) modulo the resolution
+    uint64_t offset = duration_us_ % period_us_;
+    uint64_t steps = (elapsed_us_ + period_us_ - offset) / period_us_;
+    next_us_ = start_us_ + steps * period_us_ + offset;
+    if (countdown_)
+        next_us_ = std::min(next_us_, start_us_ + duration_us_);
+
+    uint32_t irq = save_and_disable_interrupts();
+    running_ = true;
+    _render(elapsed_us_);
+    restore_interrupts(irq);
+    // 0 means the time had already passed and _alarm() ran right away
+    alarm_id_t id = add_alarm_at(from_us_since_boot(next_us_), _alarm, this, true);
+    if (id < 0)
+    {
+        running_ = false;
+        return false;
+    }
+    if (id > 0)
+        alarm_ = id;
+    return true;
+}
+
+/**
+ * @brief Private method to get the elapsed time.
+ * @param now Current time (us since boot).
+ * @return Time counted so far (us).
+ */
+uint64_t TM1637Timer::_elapsed(uint64_t now) const
+{
+    return running_ ? now - start_us_ : elapsed_us_;
+}
+
+/**
+ * @brief Private method to render the time into pending_, safe from IRQ context.
+ * @param elapsed Time counted so far (us).
+ */
+void TM1637Timer::_render(uint64_t elapsed)
+{
+    // a countdown rounds up, so it shows zero exactly at expiry
+    uint64_t t = elapsed;
+    if (countdown_)
+        t = duration_us_ - std::min(elapsed, duration_us_) + period_us_ - 1;
+    uint64_t ticks = t / period_us_;
+
+    char text[12];
+    char *p = text;
+    if (format_ == TM1637_TIMER_SSHH)
+    {
+        uint32_t s = uint32_t(std::min(ticks / 100, uint64_t(9999)));
+        uint32_t hh = (ticks / 100 > 9999) ? 99 : uint32_t(ticks % 100);
+        size_t width = (s >= 1000) ? 4 : (s >= 100) ? 3 : 2;
+        for (size_t i = width; i < 4; ++i)
+            *p++ = ' ';
+        p = _put_digits(p, s, width);
+        *p++ = '.';
+        p = _put_digits(p, hh, 2);
+    }
+    else
+    {
+        uint64_t total = std::min(ticks, uint64_t(99 * 3600 + 59 * 60 + 59));
+        uint32_t h = uint32_t(total / 3600);
+        if (h)
+        {
+            p = _put_digits(p, h, 2);
+            *p++ = '.';
+        }
+        else
+        {
+            *p++ = ' ';
+            *p++ = ' ';
+        }
+        p = _put_digits(p, uint32_t(total / 60 % 60), 2);
+        *p++ = '.';
+        p = _put_digits(p, uint32_t(total % 60), 2);
+    }
+    tm16xx_encode_text<TM1637Chip>(text, size_t(p - text), pending_, display_.font());
+    due_ = true;
+}
+
+/**
+ * @brief Private alarm callback: render, expire, and schedule the next change.
+ */
+int64_t TM1637Timer::_alarm(alarm_id_t, void *user)
+{
+    TM1637Timer &self = *static_cast<TM1637Timer *>(user);
+    uint64_t fired = self.next_us_;
+    uint64_t elapsed = fired - self.start_us_;
+    self._render(elapsed);
+
+    if (self.countdown_ && (elapsed >= self.duration_us_))
+    {
+        self.elapsed_us_ = self.duration_us_;
+        self.running_ = false;
+        self.expired_ = true;
+        self.alarm_ = 0;
+        if (self.done_)
+            self.done_(self, self.user_);
+        return 0;
+    }
+
+    self.next_us_ += self.period_us_;
+    if (self.countdown_)
+        self.next_us_ = std::min(self.next_us_, self.start_us_ + self.duration_us_);
+    // negative: relative to when this alarm was due, so the timer does not drift
+    return -int64_t(self.next_us_ - fired);
+}
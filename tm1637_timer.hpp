@@ -0,0 +1,147 @@
+/**
+ * @file tm1637_timer.hpp
+ * @brief Header file for the TM1637Timer class: countdown and stopwatch widgets driven by a hardware alarm.
+ */
+
+#ifndef TM1637_TIMER_HPP
+#define TM1637_TIMER_HPP
+
+#include "tm1637.hpp"
+
+#include <pico/time.h>
+
+/**
+ * @enum TM1637TimerFormat
+ * @brief Time layout on the six digits.
+ */
+enum TM1637TimerFormat
+{
+    TM1637_TIMER_MMSS, ///< "MM.SS", "HH.MM.SS" from one hour on; one second resolution.
+    TM1637_TIMER_SSHH  ///< "SS.hh", seconds and hundredths up to 9999.99.
+};
+
+class TM1637Timer;
+
+/**
+ * @typedef TM1637TimerCallback
+ * @brief Expiry callback, run from the alarm IRQ.
+ */
+typedef void (*TM1637TimerCallback)(TM1637Timer &timer, void *user);
+
+/**
+ * @class TM1637Timer
+ * @brief Countdown or stopwatch shown on a display, timed by a hardware alarm.
+ *
+ * The alarm fires on every change of the shown value, measured from the
+ * start time so it does not drift, renders the new digits into a buffer
+ * and, for a countdown, runs the expiry callback at the deadline. The bus
+ * is only touched by update(), called from the main loop, which sends the
+ * digits that changed; a busy main loop delays the display, never the
+ * time keeping or the callback.
+ */
+class TM1637Timer
+{
+public:
+    /**
+     * @brief Constructor for the TM1637Timer class.
+     * @param display The display to show the time on.
+     * @param format Time layout.
+     */
+    TM1637Timer(TM1637 &display, TM1637TimerFormat format = TM1637_TIMER_MMSS);
+
+    ~TM1637Timer();
+
+    /**
+     * @brief Start counting down.
+     * @param duration_ms Time until expiry (ms); 0 expires at once.
+     * @param done Optional callback run from the alarm IRQ at expiry, or
+     *             before returning for a zero duration.
+     * @param user Opaque pointer passed to done.
+     * @return false if no hardware alarm is available.
+     */
+    bool start_countdown(uint32_t duration_ms, TM1637TimerCallback done = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Start counting up from zero.
+     * @return false if no hardware alarm is available.
+     */
+    bool start_stopwatch();
+
+    /**
+     * @brief Pause, keeping the time shown.
+     */
+    void stop();
+
+    /**
+     * @brief Continue after stop(); an expired countdown stays at zero.
+     * @return false if no hardware alarm is available.
+     */
+    bool resume();
+
+    /**
+     * @brief Send the digits that changed since the last call.
+     * @return Number of digits sent.
+     */
+    size_t update();
+
+    /**
+     * @brief Get the time a stopwatch has run, or a countdown has left.
+     * @return The time (ms).
+     */
+    uint32_t time_ms() const;
+
+    /**
+     * @brief Check whether the timer is counting.
+     * @return true between start and stop or expiry.
+     */
+    bool running() const;
+
+    /**
+     * @brief Check whether a countdown has reached zero.
+     * @return true once expired.
+     */
+    bool expired() const;
+
+private:
+    /**
+     * @brief Private method to arm the alarm for the next change of the shown value.
+     * @return false if no hardware alarm is available.
+     */
+    bool _run();
+
+    /**
+     * @brief Private method to get the elapsed time.
+     * @param now Current time (us since boot).
+     * @return Time counted so far (us).
+     */
+    uint64_t _elapsed(uint64_t now) const;
+
+    /**
+     * @brief Private method to render the time into pending_, safe from IRQ context.
+     * @param elapsed Time counted so far (us).
+     */
+    void _render(uint64_t elapsed);
+
+    /**
+     * @brief Private alarm callback: render, expire, and schedule the next change.
+     */
+    static int64_t _alarm(alarm_id_t id, void *user);
+
+    TM1637 &display_;                    ///< Display the time is shown on.
+    TM1637TimerFormat format_;           ///< Time layout.
+    uint32_t period_us_;                 ///< Resolution of the shown value (us).
+    bool countdown_;                     ///< Counting down to duration_us_, otherwise a stopwatch.
+    uint64_t duration_us_;               ///< Countdown length.
+    uint64_t start_us_;                  ///< Time since boot at which the count was zero.
+    uint64_t elapsed_us_;                ///< Time counted when stopped.
+    uint64_t next_us_;                   ///< Time the alarm is scheduled for.
+    alarm_id_t alarm_;                   ///< Armed alarm, 0 if none.
+    TM1637TimerCallback done_;           ///< Expiry callback.
+    void *user_;                         ///< Opaque pointer passed to done_.
+    volatile bool running_;              ///< Counting.
+    volatile bool expired_;              ///< The countdown reached zero.
+    volatile bool due_;                  ///< pending_ holds digits not sent yet.
+    uint8_t pending_[TM1637Chip::GRIDS]; ///< Rendered digits in display order.
+};
+
+#endif // TM1637_TIMER_HPP
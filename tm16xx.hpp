@@ -0,0 +1,730 @@
+/**
+ * @file tm16xx.hpp
+ * @brief Chip descriptors, segment encoding and compile-time frame building shared by the TM16xx family.
+ *
+ * Everything here is independent of the bus transport: a chip descriptor
+ * gives the grid count, protocol, command bytes and digit wiring, and the
+ * templates below render text and frames for it at compile time or at run
+ * time through the same code.
+ */
+
+#ifndef TM16XX_HPP
+#define TM16XX_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef TM1637_RUN_FROM_RAM
+#include <pico.h>
+#define TM16XX_SEGMENTS_SECTION __not_in_flash("tm16xx_segments")
+#else
+#define TM16XX_SEGMENTS_SECTION
+#endif
+
+/**
+ * @brief Data command: write display RAM with automatic address increment.
+ */
+constexpr uint8_t TM16XX_CMD_DATA = 0x40;
+
+/**
+ * @brief Address command, or-ed with the first grid address.
+ */
+constexpr uint8_t TM16XX_CMD_ADDR = 0xC0;
+
+/**
+ * @brief Display control command, or-ed with TM16XX_DSP_ON and the brightness.
+ */
+constexpr uint8_t TM16XX_CMD_CTRL = 0x80;
+
+/**
+ * @brief Display control flag for turning on the display.
+ */
+constexpr uint8_t TM16XX_DSP_ON = 0x08;
+
+/**
+ * @brief Segment bit of the decimal point (or colon, depending on the module).
+ */
+constexpr uint8_t TM16XX_DP = 0x80;
+
+/**
+ * @brief Array of 7-segment LED segments for digits 0-9, a-z, space, dash, and star.
+ */
+// 0 - 9, a - z, blank, dash, star
+inline constexpr uint8_t TM16XX_SEGMENTS[] = {
+    0x3F, // 	0	0
+    0x06, // 	1	1
+    0x5B, // 	2	2
+    0x4F, // 	3	3
+    0x66, // 	4	4
+    0x6D, // 	5	5
+    0x7D, // 	6	6
+    0x07, // 	7	7
+    0x7F, // 	8	8
+    0x6F, // 	9	9
+    0x77, // 	10	a
+    0x7C, // 	11	b
+    0x39, // 	12	c
+    0x5E, // 	13	d
+    0x79, // 	14	e
+    0x71, // 	15	f
+    0x3D, // 	16	g
+    0x76, // 	17	h
+    0x06, // 	18	i
+    0x1E, // 	19	j
+    0x76, // 	20	k
+    0x38, // 	21	l
+    0x55, // 	22	m
+    0x54, // 	23	n
+    0x5C, // 0x3F, // 	24	o
+    0x73, // 	25	p
+    0x67, // 	26	q
+    0x50, // 	27	r
+    0x6D, // 	28	s
+    0x78, // 	29	t
+    0x3E, // 	30	u
+    0x1C, // 	31	v
+    0x2A, // 	32	w
+    0x76, // 	33	x
+    0x6E, // 	34	y
+    0x5B, // 	35	z
+    0x00, // 	36	space
+    0x40, // 	37	-
+    0x63  //	38	*
+};
+
+/**
+ * @struct TM16xxGlyph
+ * @brief Segments of one non-ASCII code point.
+ */
+struct TM16xxGlyph
+{
+    uint16_t code;    ///< Unicode code point.
+    uint8_t segments; ///< Its segments.
+};
+
+/**
+ * @brief Glyphs for the non-ASCII code points worth showing, sorted by code point.
+ *
+ * Shared by all fonts; a font overrides or extends it with TM16xxFont::with_code_point().
+ */
+inline constexpr TM16xxGlyph TM16XX_GLYPHS[] = {
+    {0x00A0, 0x00}, // no-break space
+    {0x00B0, 0x63}, // degree sign
+    {0x00B5, 0x1C}, // micro sign
+    {0x00C4, 0x77}, // A with diaeresis
+    {0x00C5, 0x77}, // A with ring
+    {0x00C9, 0x79}, // E with acute
+    {0x00D6, 0x3F}, // O with diaeresis
+    {0x00DC, 0x3E}, // U with diaeresis
+    {0x00DF, 0x6D}, // sharp s
+    {0x00E4, 0x77}, // a with diaeresis
+    {0x00E5, 0x77}, // a with ring
+    {0x00E9, 0x79}, // e with acute
+    {0x00F6, 0x5C}, // o with diaeresis
+    {0x00FC, 0x1C}, // u with diaeresis
+    {0x03BC, 0x1C}, // greek mu
+    {0x2010, 0x40}, // hyphen
+    {0x2013, 0x40}, // en dash
+    {0x2014, 0x40}, // em dash
+    {0x2018, 0x20}, // left single quotation mark
+    {0x2019, 0x02}, // right single quotation mark
+    {0x201C, 0x22}, // left double quotation mark
+    {0x201D, 0x22}, // right double quotation mark
+    {0x2212, 0x40}, // minus sign
+};
+
+/**
+ * @brief Check that TM16XX_GLYPHS is sorted, as the binary search requires.
+ * @return true if the codes are strictly increasing.
+ */
+constexpr bool tm16xx_glyphs_sorted()
+{
+    for (size_t i = 1; i < sizeof(TM16XX_GLYPHS) / sizeof(TM16XX_GLYPHS[0]); ++i)
+        if (TM16XX_GLYPHS[i - 1].code >= TM16XX_GLYPHS[i].code)
+            return false;
+    return true;
+}
+
+static_assert(tm16xx_glyphs_sorted(), "TM16XX_GLYPHS must be sorted by code point");
+
+/**
+ * @brief Look up a non-ASCII code point in TM16XX_GLYPHS.
+ * @param code Unicode code point.
+ * @return The segments, or -1 if the code point has no glyph.
+ */
+constexpr int tm16xx_find_glyph(uint32_t code)
+{
+    size_t lo = 0;
+    size_t hi = sizeof(TM16XX_GLYPHS) / sizeof(TM16XX_GLYPHS[0]);
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (TM16XX_GLYPHS[mid].code < code)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if ((lo < sizeof(TM16XX_GLYPHS) / sizeof(TM16XX_GLYPHS[0])) && (TM16XX_GLYPHS[lo].code == code))
+        return TM16XX_GLYPHS[lo].segments;
+    return -1;
+}
+
+/**
+ * @brief Called by TM16xxFont::with() for a byte outside ASCII.
+ *
+ * Not constexpr, so a compile-time font definition replacing such a byte
+ * fails to compile instead of silently overwriting an ASCII glyph.
+ */
+inline void tm16xx_font_byte_outside_ascii() {}
+
+/**
+ * @brief Called by TM16xxFont::with_code_point() when the font has no room for another code point.
+ *
+ * Not constexpr, so a compile-time font definition with too many code
+ * point glyphs fails to compile.
+ */
+inline void tm16xx_font_code_points_full() {}
+
+/**
+ * @struct TM16xxFont
+ * @brief Segment patterns for the ASCII characters.
+ *
+ * Looking up a character is a single table index. glyphs[0] (NUL, which is
+ * never shown) holds the fallback used for every byte outside ASCII.
+ * Derive compile-time fonts with with(), or copy one into RAM and change
+ * glyphs at run time with set(). Code points above U+007F are looked up in
+ * the font's own code point glyphs first, then in TM16XX_GLYPHS; add or
+ * replace them with with_code_point() and set_code_point().
+ */
+struct TM16xxFont
+{
+    static constexpr size_t CODE_POINTS = 8; ///< Code point glyphs a font can carry.
+
+    uint8_t glyphs[128];                ///< Segments per ASCII code, glyphs[0] is the fallback.
+    TM16xxGlyph code_points[CODE_POINTS]; ///< Glyphs for code points above U+007F, unsorted.
+    uint8_t code_point_count;           ///< Entries used in code_points.
+
+    /**
+     * @brief Look up the segments of a character.
+     * @param ch The character.
+     * @return The segments, the fallback for bytes outside ASCII.
+     */
+    constexpr uint8_t operator[](char ch) const
+    {
+        return glyphs[uint8_t(ch) < 128 ? uint8_t(ch) : 0];
+    }
+
+    /**
+     * @brief Copy of the font with one glyph replaced, for compile-time font definitions.
+     * @param ch The character, 0 for the fallback; a byte above 0x7F does not
+     *           compile in a constant expression and is ignored at run time.
+     * @param segments Its segments.
+     * @return The modified font.
+     */
+    constexpr TM16xxFont with(char ch, uint8_t segments) const
+    {
+        TM16xxFont font = *this;
+        if (uint8_t(ch) < 128)
+            font.glyphs[uint8_t(ch)] = segments;
+        else
+            tm16xx_font_byte_outside_ascii();
+        return font;
+    }
+
+    /**
+     * @brief Replace one glyph at run time.
+     * @param ch The character, 0 for the fallback.
+     * @param segments Its segments.
+     * @return false if ch is a byte above 0x7F, the font is then unchanged.
+     */
+    bool set(char ch, uint8_t segments)
+    {
+        if (uint8_t(ch) >= 128)
+            return false;
+        glyphs[uint8_t(ch)] = segments;
+        return true;
+    }
+
+    /**
+     * @brief Look up the segments of a code point above U+007F.
+     * @param code Unicode code point.
+     * @return The segments, or -1 if neither the font nor TM16XX_GLYPHS has a glyph.
+     */
+    constexpr int find(uint32_t code) const
+    {
+        for (size_t i = 0; i < code_point_count; ++i)
+            if (code_points[i].code == code)
+                return code_points[i].segments;
+        return tm16xx_find_glyph(code);
+    }
+
+    /**
+     * @brief Copy of the font with the glyph of a code point added or replaced, for compile-time font definitions.
+     * @param code Unicode code point; U+0000 to U+007F go to the ASCII table like with().
+     *             Adding more than CODE_POINTS code points does not compile in a constant
+     *             expression and is ignored at run time.
+     * @param segments Its segments.
+     * @return The modified font.
+     */
+    constexpr TM16xxFont with_code_point(char32_t code, uint8_t segments) const
+    {
+        TM16xxFont font = *this;
+        if (!font.set_code_point(code, segments))
+            tm16xx_font_code_points_full();
+        return font;
+    }
+
+    /**
+     * @brief Add or replace the glyph of a code point at run time.
+     * @param code Unicode code point; U+0000 to U+007F go to the ASCII table like set().
+     * @param segments Its segments.
+     * @return false if the font already carries CODE_POINTS other code points or
+     *         code does not fit TM16xxGlyph, the font is then unchanged.
+     */
+    constexpr bool set_code_point(char32_t code, uint8_t segments)
+    {
+        if (code < 128)
+        {
+            glyphs[code] = segments;
+            return true;
+        }
+        if (code > 0xFFFF)
+            return false;
+        for (size_t i = 0; i < code_point_count; ++i)
+        {
+            if (code_points[i].code == code)
+            {
+                code_points[i].segments = segments;
+                return true;
+            }
+        }
+        if (code_point_count == CODE_POINTS)
+            return false;
+        code_points[code_point_count++] = TM16xxGlyph{uint16_t(code), segments};
+        return true;
+    }
+};
+
+/**
+ * @brief Build the default font: TM16XX_SEGMENTS plus the symbols it has no room for.
+ *
+ * Letters are case-insensitive, '*' doubles as the degree sign and is also
+ * the fallback for characters without a glyph.
+ * @return The font.
+ */
+constexpr TM16xxFont tm16xx_default_font()
+{
+    TM16xxFont font{};
+    for (size_t i = 0; i < 128; ++i)
+        font.glyphs[i] = TM16XX_SEGMENTS[38];
+    for (size_t i = 0; i < 10; ++i)
+        font.glyphs['0' + i] = TM16XX_SEGMENTS[i];
+    for (size_t i = 0; i < 26; ++i)
+        font.glyphs['A' + i] = font.glyphs['a' + i] = TM16XX_SEGMENTS[10 + i];
+    font.glyphs[' '] = TM16XX_SEGMENTS[36];
+    font.glyphs['-'] = TM16XX_SEGMENTS[37];
+    font.glyphs['_'] = 0x08;
+    font.glyphs['='] = 0x48;
+    font.glyphs['['] = font.glyphs['('] = 0x39;
+    font.glyphs[']'] = font.glyphs[')'] = 0x0F;
+    font.glyphs['"'] = 0x22;
+    font.glyphs['\''] = 0x02;
+    font.glyphs['?'] = 0x53;
+    return font;
+}
+
+/**
+ * @brief Default font, used unless a display selects another one.
+ *
+ * Inline, so the program holds one copy however many translation units
+ * use it; with TM1637_RUN_FROM_RAM that copy lives in SRAM.
+ */
+inline constexpr TM16xxFont TM16XX_FONT TM16XX_SEGMENTS_SECTION = tm16xx_default_font();
+
+/**
+ * @brief Encode a character into a 7-segment LED segment.
+ * @param ch The input character.
+ * @param font Font to look the character up in.
+ * @return The encoded 7-segment LED segment.
+ */
+constexpr uint8_t tm16xx_encode_char(char ch, const TM16xxFont &font = TM16XX_FONT)
+{
+    return font[ch];
+}
+
+/**
+ * @brief Decode one UTF-8 sequence starting with a non-ASCII byte.
+ * @param str The input characters.
+ * @param len Number of characters in str.
+ * @param i Index of the lead byte, advanced past the sequence (or past the lead byte if it is malformed).
+ * @return The code point, or -1 for a malformed sequence.
+ */
+constexpr int32_t tm16xx_decode_utf8(const char *str, size_t len, size_t &i)
+{
+    uint8_t lead = uint8_t(str[i++]);
+    size_t n = (lead >= 0xF0) ? 3 : (lead >= 0xE0) ? 2 : (lead >= 0xC0) ? 1 : 0;
+    if (!n || (lead >= 0xF8))
+        return -1; // continuation byte without a lead, or invalid lead
+    int32_t code = lead & (0x3F >> n);
+    for (size_t k = 0; k < n; ++k)
+    {
+        if ((i >= len) || ((uint8_t(str[i]) & 0xC0) != 0x80))
+            return -1;
+        code = (code << 6) | (uint8_t(str[i++]) & 0x3F);
+    }
+    return code;
+}
+
+/**
+ * @enum TM16xxFallback
+ * @brief What to show for a non-ASCII character without a glyph, or malformed UTF-8.
+ */
+enum TM16xxFallback
+{
+    TM16XX_FALLBACK_GLYPH, ///< The font's fallback glyph (glyphs[0]).
+    TM16XX_FALLBACK_BLANK, ///< A blank digit.
+    TM16XX_FALLBACK_SKIP   ///< Nothing, the character takes no digit.
+};
+
+/**
+ * @enum TM16xxProtocol
+ * @brief Bus protocol spoken by a chip.
+ */
+enum TM16xxProtocol
+{
+    TM16XX_TWO_WIRE_ACK, ///< CLK/DIO with start/stop and an ACK slot after every byte (TM1637).
+    TM16XX_TWO_WIRE,     ///< CLK/DIN with start/stop, no ACK slot (TM1640).
+    TM16XX_THREE_WIRE    ///< STB/CLK/DIO, a transaction is framed by STB low (TM1638).
+};
+
+/**
+ * @struct TM1637Chip
+ * @brief Descriptor of the TM1637 on the 6-digit module this driver targets.
+ */
+struct TM1637Chip
+{
+    static constexpr TM16xxProtocol PROTOCOL = TM16XX_TWO_WIRE_ACK; ///< Bus protocol.
+    static constexpr size_t GRIDS = 6;                              ///< Digits on the module.
+    static constexpr size_t ADDR_STRIDE = 1;                        ///< Display RAM bytes per digit.
+
+    /**
+     * @brief Digit shown at a grid address; the module wires the digits in reversed groups of 3.
+     * @param addr Grid address relative to the start position.
+     * @return The digit index.
+     */
+    static constexpr size_t digit_at(size_t addr) { return (addr / 3) * 6 + 2 - addr; }
+
+    /**
+     * @brief Check whether a frame of n digits maps onto whole wiring groups.
+     * @param n Number of digits.
+     * @return true if n digits can be sent.
+     */
+    static constexpr bool fits(size_t n) { return (n % 3 == 0) && (n <= GRIDS); }
+};
+
+/**
+ * @struct TM1640Chip
+ * @brief Descriptor of the TM1640 16-grid LED driver.
+ */
+struct TM1640Chip
+{
+    static constexpr TM16xxProtocol PROTOCOL = TM16XX_TWO_WIRE; ///< Bus protocol.
+    static constexpr size_t GRIDS = 16;                         ///< Grids driven by the chip.
+    static constexpr size_t ADDR_STRIDE = 1;                    ///< Display RAM bytes per digit.
+
+    /**
+     * @brief Digit shown at a grid address, grids are wired in order.
+     * @param addr Grid address relative to the start position.
+     * @return The digit index.
+     */
+    static constexpr size_t digit_at(size_t addr) { return addr; }
+
+    /**
+     * @brief Check whether a frame of n digits can be sent.
+     * @param n Number of digits.
+     * @return true if n digits can be sent.
+     */
+    static constexpr bool fits(size_t n) { return n <= GRIDS; }
+};
+
+/**
+ * @struct TM1638Chip
+ * @brief Descriptor of the TM1638 with 8 digits, 8 LEDs and keys.
+ *
+ * Digits live at even display RAM addresses, the LED of each digit at the
+ * following odd address.
+ */
+struct TM1638Chip
+{
+    static constexpr TM16xxProtocol PROTOCOL = TM16XX_THREE_WIRE; ///< Bus protocol.
+    static constexpr size_t GRIDS = 8;                            ///< Digits on the module.
+    static constexpr size_t ADDR_STRIDE = 2;                      ///< Digit byte plus LED byte.
+
+    /**
+     * @brief Digit shown at a grid address, grids are wired in order.
+     * @param addr Grid address relative to the start position.
+     * @return The digit index.
+     */
+    static constexpr size_t digit_at(size_t addr) { return addr; }
+
+    /**
+     * @brief Check whether a frame of n digits can be sent.
+     * @param n Number of digits.
+     * @return true if n digits can be sent.
+     */
+    static constexpr bool fits(size_t n) { return n <= GRIDS; }
+};
+
+/**
+ * @brief Encode UTF-8 text into one segment byte per grid.
+ *
+ * '.' sets the decimal point of the preceding digit, the result is padded
+ * with blanks to Chip::GRIDS digits and digits beyond that are dropped,
+ * together with a '.' following them.
+ * ASCII is looked up in the font directly; other code points are decoded
+ * and looked up with TM16xxFont::find(), and rendered according to
+ * fallback when they have no glyph.
+ * @tparam Chip Chip descriptor.
+ * @param str The input characters.
+ * @param len Number of characters in str.
+ * @param out Receives Chip::GRIDS segment bytes.
+ * @param font Font to render the text with.
+ * @param fallback Rendering of characters without a glyph.
+ */
+template <class Chip>
+constexpr void tm16xx_encode_text(const char *str, size_t len, uint8_t *out, const TM16xxFont &font = TM16XX_FONT,
+                                  TM16xxFallback fallback = TM16XX_FALLBACK_GLYPH)
+{
+    for (size_t i = 0; i < Chip::GRIDS; ++i)
+        out[i] = font[' '];
+    size_t j = 0;
+    size_t i = 0;
+    bool dropped = false; // the last digit did not fit, neither does its '.'
+    while ((i < len) && str[i])
+    {
+        uint8_t seg = 0;
+        if (uint8_t(str[i]) < 0x80)
+        {
+            char ch = str[i++];
+            if ((ch == '.') && (j > 0))
+            {
+                if (!dropped)
+                    out[j - 1] |= TM16XX_DP;
+                continue;
+            }
+            seg = font[ch];
+        }
+        else
+        {
+            int32_t code = tm16xx_decode_utf8(str, len, i);
+            int glyph = (code < 0) ? -1 : font.find(uint32_t(code));
+            if (glyph >= 0)
+                seg = uint8_t(glyph);
+            else if (fallback == TM16XX_FALLBACK_SKIP)
+                continue;
+            else
+                seg = (fallback == TM16XX_FALLBACK_BLANK) ? font[' '] : font.glyphs[0];
+        }
+        dropped = (j == Chip::GRIDS);
+        if (!dropped)
+            out[j++] = seg;
+    }
+}
+
+/**
+ * @struct TM16xxFrame
+ * @brief Precompiled transaction stream for one complete frame.
+ *
+ * The stream is a sequence of transactions, each a length byte followed by
+ * that many bus bytes: the data command, the address command with the digits
+ * in the chip's wiring order, and the display control command.
+ * @tparam Chip Chip descriptor.
+ * @tparam N Number of digits in the frame.
+ */
+template <class Chip, size_t N>
+struct TM16xxFrame
+{
+    uint8_t bytes[N * Chip::ADDR_STRIDE + 6]; ///< Length-prefixed transactions.
+
+    /**
+     * @brief Size of the stream in bytes.
+     * @return The number of bytes in the stream.
+     */
+    constexpr size_t size() const { return sizeof(bytes); }
+};
+
+/**
+ * @brief Build the transaction stream for a frame of pre-encoded segments at compile time.
+ *
+ * On chips with an address stride of 2 the byte following each digit (the
+ * TM1638 LEDs) is cleared.
+ * @tparam Chip Chip descriptor.
+ * @param segments Array of 7-segment LED segments.
+ * @param brightness Brightness level for the display (0-7).
+ * @param pos Starting position on the display.
+ * @return The precompiled frame.
+ */
+template <class Chip, size_t N>
+constexpr TM16xxFrame<Chip, N> tm16xx_frame(const uint8_t (&segments)[N], uint8_t brightness = 7, uint8_t pos = 0)
+{
+    static_assert(Chip::fits(N), "frame length does not fit the chip's digit wiring");
+    TM16xxFrame<Chip, N> frame{};
+    size_t j = 0;
+    frame.bytes[j++] = 1;
+    frame.bytes[j++] = TM16XX_CMD_DATA;
+    frame.bytes[j++] = uint8_t(N * Chip::ADDR_STRIDE + 1);
+    frame.bytes[j++] = TM16XX_CMD_ADDR | (pos < Chip::GRIDS ? pos : Chip::GRIDS - 1) * Chip::ADDR_STRIDE;
+    for (size_t i = 0; i < N; ++i)
+    {
+        frame.bytes[j++] = segments[Chip::digit_at(i)];
+        for (size_t k = 1; k < Chip::ADDR_STRIDE; ++k)
+            frame.bytes[j++] = 0;
+    }
+    frame.bytes[j++] = 1;
+    frame.bytes[j++] = TM16XX_CMD_CTRL | TM16XX_DSP_ON | (brightness & 0x07);
+    return frame;
+}
+
+/**
+ * @brief Build the transaction stream for a text frame at compile time.
+ * @tparam Chip Chip descriptor.
+ * @param str The input string literal, encoded like tm16xx_encode_text().
+ * @param brightness Brightness level for the display (0-7).
+ * @param font Font to render the text with.
+ * @return The precompiled frame.
+ */
+template <class Chip, size_t L>
+constexpr TM16xxFrame<Chip, Chip::GRIDS> tm16xx_frame(const char (&str)[L], uint8_t brightness = 7,
+                                                       const TM16xxFont &font = TM16XX_FONT)
+{
+    uint8_t segments[Chip::GRIDS] = {};
+    tm16xx_encode_text<Chip>(str, L - 1, segments, font);
+    return tm16xx_frame<Chip>(segments, brightness);
+}
+
+/**
+ * @enum TM16xxSegment
+ * @brief Segment indices within a digit.
+ */
+enum TM16xxSegment
+{
+    TM16XX_SEG_A = 0, ///< Top.
+    TM16XX_SEG_B,     ///< Top right.
+    TM16XX_SEG_C,     ///< Bottom right.
+    TM16XX_SEG_D,     ///< Bottom.
+    TM16XX_SEG_E,     ///< Bottom left.
+    TM16XX_SEG_F,     ///< Top left.
+    TM16XX_SEG_G,     ///< Middle.
+    TM16XX_SEG_DP     ///< Decimal point.
+};
+
+/**
+ * @class TM16xxFramebuffer
+ * @brief Off-screen copy of the digits of a display, sent in one flush.
+ *
+ * Drawing calls only change the buffer. flush() hands it to the display's
+ * write_changed(), which sends the digits that differ from what the display
+ * shows as one address span, so any number of changes costs a single data
+ * transaction. Out-of-range digits are ignored.
+ * @tparam Chip Chip descriptor, fixes the number of digits.
+ * @tparam Display Driver of the display, providing
+ *         size_t write_changed(const uint8_t *segments) over Chip::GRIDS digits.
+ */
+template <class Chip, class Display>
+class TM16xxFramebuffer
+{
+public:
+    /**
+     * @brief Constructor for the TM16xxFramebuffer class, starting blank.
+     * @param display The display to flush to.
+     */
+    explicit TM16xxFramebuffer(Display &display) : display_(display), segments_() {}
+
+    /**
+     * @brief Light a segment.
+     * @param digit Digit (0 to Chip::GRIDS - 1).
+     * @param seg Segment index.
+     */
+    void set(uint8_t digit, TM16xxSegment seg) { write(digit, 0xFF, uint8_t(1u << seg)); }
+
+    /**
+     * @brief Turn a segment off.
+     * @param digit Digit (0 to Chip::GRIDS - 1).
+     * @param seg Segment index.
+     */
+    void clear(uint8_t digit, TM16xxSegment seg) { write(digit, 0x00, uint8_t(1u << seg)); }
+
+    /**
+     * @brief Invert a segment.
+     * @param digit Digit (0 to Chip::GRIDS - 1).
+     * @param seg Segment index.
+     */
+    void toggle(uint8_t digit, TM16xxSegment seg)
+    {
+        if (digit < Chip::GRIDS)
+            segments_[digit] ^= uint8_t(1u << seg);
+    }
+
+    /**
+     * @brief Check whether a segment is lit in the buffer.
+     * @param digit Digit (0 to Chip::GRIDS - 1).
+     * @param seg Segment index.
+     * @return true if the segment is lit.
+     */
+    bool get(uint8_t digit, TM16xxSegment seg) const
+    {
+        return (digit < Chip::GRIDS) && (segments_[digit] & (1u << seg));
+    }
+
+    /**
+     * @brief Replace some segments of a digit.
+     * @param digit Digit (0 to Chip::GRIDS - 1).
+     * @param segments New segment bits.
+     * @param mask Segment bits to replace, the others are kept.
+     */
+    void write(uint8_t digit, uint8_t segments, uint8_t mask = 0xFF)
+    {
+        if (digit < Chip::GRIDS)
+            segments_[digit] = uint8_t((segments_[digit] & ~mask) | (segments & mask));
+    }
+
+    /**
+     * @brief Copy a span of digits into the buffer.
+     * @param segments Segment bytes, one per digit.
+     * @param count Number of digits, clipped at the last digit.
+     * @param pos First digit written (0 to Chip::GRIDS - 1).
+     * @param mask Segment bits to replace in every digit, the others are kept.
+     */
+    void blit(const uint8_t *segments, size_t count, uint8_t pos = 0, uint8_t mask = 0xFF)
+    {
+        for (size_t i = 0; (i < count) && (pos + i < Chip::GRIDS); ++i)
+            write(uint8_t(pos + i), segments[i], mask);
+    }
+
+    /**
+     * @brief Blank all digits in the buffer.
+     */
+    void clear_all()
+    {
+        for (size_t i = 0; i < Chip::GRIDS; ++i)
+            segments_[i] = 0;
+    }
+
+    /**
+     * @brief Get the buffer.
+     * @return Chip::GRIDS segment bytes in display order.
+     */
+    const uint8_t *segments() const { return segments_; }
+
+    /**
+     * @brief Send the changes to the display.
+     * @return Number of digits sent.
+     */
+    size_t flush() { return display_.write_changed(segments_); }
+
+private:
+    Display &display_;              ///< Display the buffer is flushed to.
+    uint8_t segments_[Chip::GRIDS]; ///< Digits in display order.
+};
+
+#endif // TM16XX_HPP
@@ -0,0 +1,191 @@
+/**
+ * @file tm1637_scenegen.cpp
+ * @brief Host tool compiling text scene descriptions into flash-resident TM1637Page arrays.
+ *
+ * Input, one statement per line, '#' starts a comment:
+ *
+ *     scene <name>
+ *     page "<text>" [brightness=<0-7>] [duration=<ms>] [blink]
+ *
+ * Every scene becomes a constexpr TM1637Page array <name>[] plus a
+ * <name>_count constant in the generated header. The text is rendered with
+ * the same tm16xx.hpp code as TM1637::show().
+ *
+ * Usage: tm1637_scenegen <input.scene> <output.hpp>
+ */
+
+#include "../tm1637_scene.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+/**
+ * @brief Report an error in the input and exit.
+ * @param file Input file name.
+ * @param line Line number.
+ * @param msg Error message.
+ */
+static void fail(const char *file, int line, const char *msg)
+{
+    std::fprintf(stderr, "%s:%d: %s\n", file, line, msg);
+    std::exit(1);
+}
+
+/**
+ * @brief Parse an unsigned decimal option value.
+ * @param s The value.
+ * @param max Largest accepted value.
+ * @param out Receives the value.
+ * @return false if s is not a number up to max.
+ */
+static bool parse_value(const std::string &s, unsigned long max, unsigned long &out)
+{
+    if (s.empty() || !std::isdigit((unsigned char)s[0]))
+        return false;
+    char *end = nullptr;
+    out = std::strtoul(s.c_str(), &end, 10);
+    return (*end == '\0') && (out <= max);
+}
+
+/**
+ * @brief Check that a scene name is a valid C++ identifier.
+ * @param s The name.
+ * @return true if s can be used as an identifier.
+ */
+static bool is_identifier(const std::string &s)
+{
+    if (s.empty() || std::isdigit((unsigned char)s[0]))
+        return false;
+    for (char c : s)
+        if (!std::isalnum((unsigned char)c) && (c != '_'))
+            return false;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::fprintf(stderr, "usage: %s <input.scene> <output.hpp>\n", argv[0]);
+        return 2;
+    }
+    const char *in_name = argv[1];
+    FILE *in = std::fopen(in_name, "r");
+    if (!in)
+    {
+        std::perror(in_name);
+        return 1;
+    }
+
+    std::string body;
+    std::string scene;
+    size_t pages = 0;
+    char buf[512];
+    int line = 0;
+    auto close_scene = [&]()
+    {
+        if (scene.empty())
+            return;
+        if (!pages)
+            fail(in_name, line, "scene without pages");
+        body += "};\nconstexpr size_t " + scene + "_count = " + std::to_string(pages) + ";\n\n";
+    };
+
+    while (std::fgets(buf, sizeof(buf), in))
+    {
+        ++line;
+        std::string s(buf);
+        size_t p = 0;
+        auto skip_space = [&]()
+        {
+            while ((p < s.size()) && std::isspace((unsigned char)s[p]))
+                ++p;
+        };
+        auto word = [&]()
+        {
+            skip_space();
+            size_t b = p;
+            while ((p < s.size()) && !std::isspace((unsigned char)s[p]) && (s[p] != '#'))
+                ++p;
+            return s.substr(b, p - b);
+        };
+
+        std::string keyword = word();
+        if (keyword.empty())
+            continue;
+        if (keyword == "scene")
+        {
+            close_scene();
+            scene = word();
+            if (!is_identifier(scene))
+                fail(in_name, line, "scene name must be an identifier");
+            pages = 0;
+            body += "constexpr TM1637Page " + scene + "[] = {\n";
+        }
+        else if (keyword == "page")
+        {
+            if (scene.empty())
+                fail(in_name, line, "page outside of a scene");
+            skip_space();
+            if ((p >= s.size()) || (s[p] != '"'))
+                fail(in_name, line, "expected quoted page text");
+            size_t end = s.find('"', p + 1);
+            if (end == std::string::npos)
+                fail(in_name, line, "unterminated page text");
+            std::string text = s.substr(p + 1, end - p - 1);
+            p = end + 1;
+
+            unsigned long brightness = 7, duration = 0;
+            uint8_t attributes = 0;
+            for (std::string opt = word(); !opt.empty(); opt = word())
+            {
+                if (opt.compare(0, 11, "brightness=") == 0)
+                {
+                    if (!parse_value(opt.substr(11), 7, brightness))
+                        fail(in_name, line, "brightness must be 0-7");
+                }
+                else if (opt.compare(0, 9, "duration=") == 0)
+                {
+                    if (!parse_value(opt.substr(9), 65535, duration))
+                        fail(in_name, line, "duration must be 0-65535 ms");
+                }
+                else if (opt == "blink")
+                    attributes |= TM1637_PAGE_BLINK;
+                else
+                    fail(in_name, line, "unknown page option");
+            }
+
+            uint8_t segments[TM1637Chip::GRIDS];
+            tm16xx_encode_text<TM1637Chip>(text.c_str(), text.size(), segments);
+            TM1637Frame<6> frame = tm1637_frame(segments, uint8_t(brightness));
+            char item[32];
+            body += "    // \"" + text + "\"\n    {{{";
+            for (size_t i = 0; i < frame.size(); ++i)
+            {
+                std::snprintf(item, sizeof(item), "%s0x%02x", i ? ", " : "", frame.bytes[i]);
+                body += item;
+            }
+            std::snprintf(item, sizeof(item), "}}, %lu, 0x%02x},\n", duration, attributes);
+            body += item;
+            ++pages;
+        }
+        else if (keyword[0] != '#')
+            fail(in_name, line, "expected 'scene' or 'page'");
+    }
+    close_scene();
+    std::fclose(in);
+
+    FILE *out = std::fopen(argv[2], "w");
+    if (!out)
+    {
+        std::perror(argv[2]);
+        return 1;
+    }
+    std::fprintf(out, "// Generated by tm1637_scenegen from %s, do not edit.\n"
+                      "#pragma once\n\n#include \"tm1637_scene.hpp\"\n\n%s",
+                 in_name, body.c_str());
+    return std::fclose(out) ? 1 : 0;
+}